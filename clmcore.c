@@ -0,0 +1,1047 @@
+/* Curse of the lost miner - hardware independent game core.
+ * See clmcore.h. This file is linked into the cartridge and into the
+ * host tools, so it must stay free of any 5200 specifics.
+ */
+
+#ifdef __CC65__
+#pragma codesize(100)
+#endif
+
+#include <string.h>
+#include "clmcore.h"
+
+/*The game in progress*/
+CLM_TLS ClmState clm;
+CLM_TLS unsigned char* clmScreen;
+
+/*Paint queue, see clmcore.h*/
+CLM_TLS unsigned char clmPaintQueued;
+CLM_TLS unsigned char clmPaintHead;
+CLM_TLS unsigned char clmPaintTail;
+CLM_TLS unsigned char clmPaintLo[CLM_PAINT_QUEUE_SIZE];
+CLM_TLS unsigned char clmPaintHi[CLM_PAINT_QUEUE_SIZE];
+CLM_TLS unsigned char clmPaintChar[CLM_PAINT_QUEUE_SIZE];
+
+/*Temporary variables for general use*/
+static CLM_TLS unsigned char x1;
+static CLM_TLS unsigned char y1;
+static CLM_TLS unsigned int i2;
+static CLM_TLS unsigned char z1;
+
+/*Cells of the cave rows, the extra row is the rock below the cave*/
+const unsigned int clmCellRow[CAVE_HEIGHT + 1] = {
+    0, 20, 40, 60, 80, 100, 120, 140, 160, 180, 200,
+    220, 240, 260, 280, 300, 320, 340, 360, 380, 400, 420, 440
+};
+
+/*Cave decoded ahead, see clmPrepareCave(). The elements come last, the
+ *decoder reads the row above them
+ */
+typedef struct {
+    unsigned char minerX;
+    unsigned char minerY;
+    unsigned char diamondsInCave;
+    unsigned char brokenCount;
+    unsigned int brokenCell[CLM_BROKEN_SIZE];
+    unsigned char caveElements[CAVE_CELLS];
+} PreparedCave;
+
+static CLM_TLS PreparedCave prepared;
+CLM_TLS unsigned char clmPreparedCave = CLM_NO_CAVE;
+
+/*Packed cave reader and where the decoder goes on from*/
+static CLM_TLS const unsigned char* packNext;
+static CLM_TLS unsigned char packLow;
+static CLM_TLS unsigned char* decodeElement;
+static CLM_TLS unsigned char* decodeScreen;
+static CLM_TLS unsigned char decodeDiamond; /*Diamond type cycles 1, 2, 0, 1...*/
+
+/*Broken rock found last, see findRock()*/
+static CLM_TLS unsigned char lastRock;
+
+/*Broken rocks marked to decay in this frame, see markRock()*/
+static CLM_TLS unsigned char rocksMarked;
+
+/*Rows around the miner, see locateMiner()*/
+static CLM_TLS unsigned char* rowAbove;
+static CLM_TLS unsigned char* rowHere;
+static CLM_TLS unsigned char* rowBelow;
+
+/*Element attributes*/
+#define A_PASSABLE (1) /*The miner can enter*/
+#define A_FALL (2) /*Passable and no ladder, gravity pulls through*/
+#define A_NO_JUMP (4) /*Nothing to jump off*/
+#define A_LADDER (8)
+#define A_BROKEN (16)
+#define A_DIAMOND (32)
+#define A_DEATH_BELOW (64) /*Kills the miner standing on it*/
+#define A_DEATH_ABOVE (128) /*Kills the miner entering it from below*/
+
+/*Jump moves*/
+#define JM_LAND (0)
+#define JM_UP (1)
+#define JM_SIDE (2) /*One cell the way the jump goes*/
+
+/*Jump paths - pairs of a move and the frames until the next move. The
+ *first move is made in the frame the jump starts. A high jump lets the
+ *miner step aside once while he is in the air
+ */
+static const unsigned char jumpPaths[] = {
+    /*Medium jump, JUMP_PATH_MEDIUM*/
+    JM_UP, CTRL_DELAY,
+    JM_UP, CTRL_DELAY,
+    JM_SIDE, CTRL_DELAY,
+    JM_SIDE, CTRL_DELAY,
+    JM_SIDE, CTRL_DELAY,
+    JM_LAND,
+    /*High jump at normal speed, JUMP_PATH_HIGH_NORMAL*/
+    JM_UP, 6,
+    JM_UP, 6,
+    JM_UP, 20,
+    JM_LAND,
+    /*High jump at slow speed, JUMP_PATH_HIGH_SLOW*/
+    JM_UP, 8,
+    JM_UP, 8,
+    JM_UP, 26,
+    JM_LAND
+};
+
+#define JUMP_PATH_MEDIUM (0)
+#define JUMP_PATH_HIGH_NORMAL (11)
+#define JUMP_PATH_HIGH_SLOW (18)
+
+static const unsigned char elemAttr[] = {
+
+    A_PASSABLE | A_FALL | A_NO_JUMP, /*BLANK*/
+
+    0, /*ROCK FULL*/
+
+    0, /*ROCK TL*/
+    0, /*ROCK TR*/
+    0, /*ROCK BL*/
+    0, /*ROCK BR*/
+
+    0, /*ROCK UNSTABLE*/
+
+    A_PASSABLE | A_LADDER, /*LADDER*/
+
+    A_DEATH_BELOW, /*DEATH BOTTOM TOP*/
+    A_DEATH_ABOVE, /*DEATH TOP BOTTOM*/
+
+    A_PASSABLE | A_FALL | A_NO_JUMP | A_DIAMOND, /*DIAM 1*/
+    A_PASSABLE | A_FALL | A_NO_JUMP | A_DIAMOND, /*DIAM 2*/
+    A_PASSABLE | A_FALL | A_NO_JUMP | A_DIAMOND, /*DIAM 3*/
+
+    A_BROKEN, /*BROKEN 1*/
+    A_BROKEN, /*BROKEN 2*/
+    A_BROKEN, /*BROKEN 3*/
+    A_BROKEN, /*BROKEN 4*/
+    A_BROKEN, /*BROKEN 5*/
+    A_BROKEN, /*BROKEN 6*/
+    A_BROKEN, /*BROKEN 7*/
+    A_BROKEN, /*BROKEN 8*/
+
+    0, /*SKULL*/
+    0 /*SKULL 2*/
+};
+
+/*Map cave elements to character pairs*/
+static const unsigned char elem2CharMap[] = {
+
+    0, /*BLANK*/
+
+    64 + 128, /*ROCK FULL*/
+
+    72 + 128, /*ROCK TL*/
+    74 + 128, /*ROCK TR*/
+    70 + 128, /*ROCK BL*/
+    68 + 128, /*ROCK BR*/
+
+    90 + 128, /*ROCK UNSTABLE*/
+
+    78, /*LADDER*/
+
+    66 + 128, /*DEATH BOTTOM TOP*/
+    76 + 128, /*DEATH TOP BOTTOM*/
+
+    84, /*DIAM 1*/
+    86, /*DIAM 2*/
+    88, /*DIAM 3*/
+
+    97 + 128, /*BROKEN 1*/
+    99 + 128, /*BROKEN 2*/
+    101 + 128, /*BROKEN 3*/
+    103 + 128, /*BROKEN 4*/
+    105 + 128, /*BROKEN 5*/
+    107 + 128, /*BROKEN 6*/
+    109 + 128, /*BROKEN 7*/
+    111 + 128, /*BROKEN 8*/
+
+    80, /*SKULL*/
+    82 /*SKULL 2*/
+};
+
+/*Screen offsets of the cave rows, so painting needs no multiplication*/
+static const unsigned int rowOffset[CAVE_HEIGHT] = {
+    0, 40, 80, 120, 160, 200, 240, 280, 320, 360, 400,
+    440, 480, 520, 560, 600, 640, 680, 720, 760, 800, 840
+};
+
+/*Miner movement*/
+static void locateMiner(void);
+static unsigned char moveLeft(void);
+static unsigned char moveRight(void);
+static void moveUp(void);
+static void moveDown(void);
+static unsigned char jumpUp(void); /*Return 0 if OK, 1 if death*/
+static void fallDown(void);
+static void startJump(unsigned char type, unsigned char path);
+static unsigned char jumpMove(void); /*Return 1 if the jump is over*/
+static void advanceJump(unsigned char input);
+static void endJump(void);
+static unsigned char checkTreasure(void);
+static void checkDeath(void);
+static void adjustGameSpeed(unsigned char speed);
+static unsigned char packNibble(void);
+static const unsigned char* findCave(unsigned char cv);
+static void takeCave(void);
+static void resetCaveStatus(void);
+static void logCell(unsigned char x, unsigned char y, unsigned char elem);
+static void addRocks(const unsigned char* e, unsigned char run);
+static unsigned char findRock(unsigned int cell);
+static void markRock(unsigned char r);
+static void decayRocks(void);
+static void decayRock(unsigned char r);
+static void paintCell(unsigned int cell, unsigned char elem);
+static void putCell(void);
+
+/*Start a new game*/
+void clmNewGame(unsigned char type, unsigned char startCave, unsigned char speed) {
+
+    clm.gameType = type;
+    clm.gameOverType = GAME_OVER_NONE;
+    adjustGameSpeed(speed);
+
+    /*Set current cave and number of lives*/
+    if (type == GAME_TYPE_NORMAL) {
+        clm.currentCave = startCave;
+    } else {
+        clm.currentCave = TRAINING_CAVE_INDEX;
+    }
+
+    clm.lives = 4;
+    clm.caveDeath = 0;
+    clmPreparedCave = CLM_NO_CAVE;
+}
+
+/*Enter the current cave, either fresh or after a death*/
+void clmStartCave() {
+
+    /*Rebuild cave array and paint it*/
+    rebuildCaveElementArray(clm.currentCave);
+    resetCaveStatus();
+}
+
+/*Enter the current cave, decoded ahead*/
+void clmEnterCave() {
+    takeCave();
+    resetCaveStatus();
+}
+
+/*Enter the current cave again after a death. The cells in the undo log
+ *and the broken rocks that crumbled get their elements back and are
+ *repainted, so is the cell the miner died in. Everything else on the
+ *screen is left as it is. The cells are written at once, more of them
+ *than the paint queue holds and the cell of the miner may be among
+ *those in the log
+ */
+void clmRestartCave() {
+
+    const unsigned char* start;
+    unsigned char queued = clmPaintQueued;
+
+    /*Too much changed, start from scratch*/
+    if (clm.undoCount > CLM_UNDO_SIZE) {
+        clmStartCave();
+        return;
+    }
+
+    clmPaintQueued = 0;
+
+    /*Skull*/
+    paintElement(clm.minerX, clm.minerY, clm.caveElements[CLM_CELL(clm.minerX, clm.minerY)]);
+
+    while (clm.undoCount != 0) {
+        --clm.undoCount;
+        x1 = clm.undoX[clm.undoCount];
+        y1 = clm.undoY[clm.undoCount];
+        i2 = CLM_CELL(x1, y1);
+        clm.caveElements[i2] = clm.undoElement[clm.undoCount];
+        paintElement(x1, y1, clm.caveElements[i2]);
+    }
+
+    for (x1 = 0; x1 != clm.brokenCount; ++x1) {
+        clm.brokenTicks[x1] = 0;
+        i2 = clm.brokenCell[x1];
+        if (clm.caveElements[i2] != E_ROCK_BROKEN_F) {
+            clm.caveElements[i2] = E_ROCK_BROKEN_F;
+            paintCell(i2, E_ROCK_BROKEN_F);
+        }
+    }
+
+    clmPaintQueued = queued;
+
+    /*Miner back at the start*/
+    start = findCave(clm.currentCave);
+    clm.minerY = start[0];
+    clm.minerX = start[1];
+    resetCaveStatus();
+}
+
+/*Status of a cave just entered*/
+void resetCaveStatus() {
+    clm.diamondsCollected = 0;
+    clm.undoCount = 0;
+    clm.stayHere = 1;
+    clm.caveDeath = 0;
+    clm.caveAllPicked = 0;
+    clm.caveQuit = 0;
+    clm.mvDelay = 0;
+    clm.fallCounter = 0;
+    clm.fallLength = 0;
+    clm.fallMovementFlags = FALL_FLAG_NONE;
+    clm.landLock = 0;
+    clm.jumpType = JUMP_NONE;
+}
+
+/*Controls and physics for one frame*/
+unsigned char clmStep(unsigned char input) {
+
+    /*Elements near miner*/
+    unsigned char probeBelow;
+    unsigned char probeMiner;
+
+    if (clm.stayHere == 0) return 0;
+
+    locateMiner();
+
+    /*Movement delay*/
+    if (clm.mvDelay != 0) --clm.mvDelay;
+
+    /*Keypad * or RESET - Return to menu*/
+    if (input & KP_LOG_QUIT) {
+        clm.stayHere = 0;
+        clm.caveQuit = 1;
+        return 0;
+    }
+
+    /*Keypad 0 - Commit Suicide*/
+    if (input & KP_LOG_SUICIDE) {
+        clm.caveDeath = 1;
+        clm.stayHere = 0;
+        return 0;
+    }
+
+    /*A jump in progress moves the miner, gravity and controls wait*/
+    if (clm.jumpType != JUMP_NONE) {
+        advanceJump(input);
+        return clm.stayHere;
+    }
+
+    /*Whats is behind the miner a what is below the miner?*/
+    probeMiner = rowHere[clm.minerX];
+    probeBelow = rowBelow[clm.minerX];
+
+    /*Gravity - If there is nothing below the miner and the miner is not on a ladder, he falls down.*/
+    if ((elemAttr[probeBelow] & A_FALL) && probeMiner != E_LADDER) {
+        clm.fallCounter++;
+        if (clm.fallCounter == clm.fallSpeed) {
+            fallDown();
+            clm.fallLength++;
+            checkDeath();
+            clm.fallCounter = 0;
+            if (clm.fallLength > 6) {
+                clm.stayHere = 0;
+                clm.caveDeath = 1;
+                return 0;
+            }
+        }
+        clm.fallMovementFlags |= FALL_FLAG_FALLING;
+        clm.landLock = 0;
+    } else {
+        if ((clm.fallMovementFlags & (FALL_FLAG_LEFT_AND_RIGHT)) != 0) {
+            clm.landLock = 2;
+        }
+        clm.fallCounter = 0;
+        clm.fallLength = 0;
+        clm.fallMovementFlags = FALL_FLAG_NONE;
+    }
+
+    /*There is a broken rock under the miner. It decays*/
+    if (elemAttr[probeBelow] & A_BROKEN) {
+        markRock(findRock(CLM_CELL(clm.minerX, clm.minerY + 1)));
+    }
+    decayRocks();
+
+    /*Unstable rock under the miner*/
+    if (probeBelow == E_ROCK_UNSTABLE) {
+        logCell(clm.minerX, clm.minerY + 1, E_ROCK_UNSTABLE);
+        rowBelow[clm.minerX] = E_BLANK;
+        paintElement(clm.minerX, clm.minerY + 1, E_BLANK);
+    }
+
+    /*Controls*/
+    if (clm.mvDelay == 0) {
+
+        switch (input & JS_LOG_DIRECTIONS) {
+
+                /*Joystick right*/
+            case JS_LOG_UP_RIGHT:
+            case JS_LOG_RIGHT:
+            {
+
+                /*With trigger - Medium jump to right*/
+                if ((input & JS_LOG_FIRE) && !(elemAttr[probeBelow] & A_NO_JUMP)) {
+                    rmtPlayJump();
+                    clm.fallLength = 0;
+                    startJump(JUMP_RIGHT, JUMP_PATH_MEDIUM);
+                    break;
+                }
+                /*Without trigger - Move to the right*/
+
+                /*When falling - allow move to the right just once*/
+                if ((clm.fallMovementFlags & FALL_FLAG_FALLING) == FALL_FLAG_FALLING) {
+                    if ((clm.fallMovementFlags & FALL_FLAG_RIGHT) == 0) {
+                        if (moveRight()) clm.fallMovementFlags |= FALL_FLAG_RIGHT;
+                    }
+                }/*Otherwise just move to the right*/
+                else {
+                    if (clm.landLock == 0) {
+                        moveRight();
+                    } else {
+                        --clm.landLock;
+                        clm.mvDelay = clm.controlDelay;
+                    }
+                }
+
+
+                checkDeath();
+                break;
+            }
+
+                /*Joystick left*/
+            case JS_LOG_UP_LEFT:
+            case JS_LOG_LEFT:
+            {
+                /*With trigger - Medium jump to the left*/
+                if ((input & JS_LOG_FIRE) && !(elemAttr[probeBelow] & A_NO_JUMP)) {
+                    rmtPlayJump();
+                    clm.fallLength = 0;
+                    startJump(JUMP_LEFT, JUMP_PATH_MEDIUM);
+                    break;
+                }
+                /*Without trigger - Simply movet to the left*/
+
+                /*When falling - allow move to the left just once*/
+                if ((clm.fallMovementFlags & FALL_FLAG_FALLING) == FALL_FLAG_FALLING) {
+                    if ((clm.fallMovementFlags & FALL_FLAG_LEFT) == 0) {
+                        if (moveLeft()) clm.fallMovementFlags |= FALL_FLAG_LEFT;
+                    }
+                }/*Otherwise just move to the left*/
+                else {
+                    if (clm.landLock == 0) {
+                        moveLeft();
+                    } else {
+                        --clm.landLock;
+                        clm.mvDelay = clm.controlDelay;
+                    }
+
+                }
+                checkDeath();
+                break;
+            }
+
+
+                /*Joystick down, move down (ladder only)*/
+            case JS_LOG_DOWN:
+            {
+                moveDown();
+                checkDeath();
+                break;
+            }
+
+                /*Joystick up, move up (ladder only) or jump high*/
+            case JS_LOG_UP:
+            {
+                if (input & JS_LOG_FIRE) {
+                    if (elemAttr[probeBelow] & A_NO_JUMP) break;
+                    clm.fallLength = 0;
+                    rmtPlayJump();
+                    clm.mvDelay = 0; /*Reset Movement delay*/
+                    startJump(JUMP_HIGH, clm.highJumpPath);
+                    break;
+                }
+                moveUp();
+                checkDeath();
+                break;
+            }
+
+            default:
+            {
+                clm.mvDelay = 0;
+                clm.landLock = 0;
+            }
+
+        }/*End switch js*/
+    }
+
+    return clm.stayHere;
+}
+
+/*Decide what happens after the cave is over*/
+unsigned char clmEndCave() {
+
+    /* Return to main menu by user request*/
+    if (clm.caveQuit) {
+        clm.gameOverType = GAME_OVER_USER_QUIT;
+        return clm.gameOverType;
+    }
+
+    /* Treasure collected. Advance to next cave or complete the game*/
+    if (clm.caveAllPicked) {
+
+        /*If training, then return to the main menu*/
+        if (clm.gameType == GAME_TYPE_TRAINING) {
+            clm.gameOverType = GAME_OVER_USER_QUIT;
+            return clm.gameOverType;
+        }
+
+        clm.currentCave++;
+        if (clm.currentCave == NUMBER_OF_CAVES) {
+            clm.gameOverType = GAME_OVER_SUCCESS;
+            return clm.gameOverType;
+        }
+
+        /*Play positive sound*/
+        rmtPlayPicked();
+        return clm.gameOverType;
+    }
+
+    /*Check remaining lives lives*/
+    if (clm.caveDeath) {
+        if (clm.lives == 0) {
+            clm.gameOverType = GAME_OVER_DEATH;
+            return clm.gameOverType;
+        }
+        clm.lives--;
+    }
+
+    return clm.gameOverType;
+}
+
+/*Nothing in progress - the next frame is up to the player*/
+unsigned char clmMinerAtRest() {
+
+    if (clm.jumpType != JUMP_NONE || clm.mvDelay > 1) return 0;
+
+    /*Would gravity take the miner?*/
+    locateMiner();
+    if ((elemAttr[rowBelow[clm.minerX]] & A_FALL) && rowHere[clm.minerX] != E_LADDER) return 0;
+
+    return 1;
+}
+
+/*Paint element at specific location*/
+void paintElement(unsigned char x, unsigned char y, unsigned char elem) {
+
+    /*Target memory*/
+    i2 = rowOffset[y] + (x << 1);
+
+    /*Mapping for element*/
+    z1 = elem2CharMap[elem];
+
+    putCell();
+}
+
+/*Paint element in a cell of caveElements, two characters each*/
+void paintCell(unsigned int cell, unsigned char elem) {
+    i2 = cell << 1;
+    z1 = elem2CharMap[elem];
+    putCell();
+}
+
+/*Characters z1 and z1 + 1 to screen offset i2, now or from the queue*/
+void putCell() {
+    unsigned char* s;
+    unsigned char next;
+
+    s = clmScreen + i2;
+    if (clmPaintQueued) {
+        next = (clmPaintHead + 1) & (CLM_PAINT_QUEUE_SIZE - 1);
+        if (next != clmPaintTail) {
+            clmPaintLo[clmPaintHead] = CLM_ADDR(s) & 0xFF;
+            clmPaintHi[clmPaintHead] = CLM_ADDR(s) >> 8;
+            clmPaintChar[clmPaintHead] = z1;
+            clmPaintHead = next;
+            return;
+        }
+    }
+    s[0] = z1;
+    s[1] = z1 + 1;
+}
+
+/*"Training" literal*/
+static const unsigned char trainingLiteral[] = {52, 50, 33, 41, 46, 41, 46, 39};
+
+/*Paint the status bar below the cave - lives, then the caves reached or
+ *"Training"
+ */
+void updateStatusBar() {
+
+    unsigned char* s = clmScreen + CAVE_HEIGHT * 40;
+
+    /*Clear*/
+    memset(s, 0, 40);
+
+    /*Lives*/
+    for (y1 = 0; y1 < clm.lives; y1++) {
+        s[y1] = 123;
+    }
+
+    /*Current cave*/
+    if (clm.gameType == GAME_TYPE_TRAINING) {
+        memcpy(s + 32, trainingLiteral, 8);
+    } else {
+        x1 = (40 - NUMBER_OF_CAVES) + clm.currentCave + 1;
+        for (y1 = 40 - NUMBER_OF_CAVES; y1 < x1; y1++) {
+            s[y1] = 96;
+        }
+    }
+
+}
+
+/*Paint whole cave. Rows are 40 characters, so the screen is one run*/
+void paintCave() {
+
+    unsigned char* s = clmScreen;
+    unsigned char* e = clm.caveElements;
+
+    for (y1 = 0; y1 < CAVE_HEIGHT; ++y1) {
+        for (x1 = 0; x1 < CAVE_WIDTH; ++x1) {
+            z1 = elem2CharMap[*e++];
+            *s++ = z1;
+            *s++ = z1 + 1;
+        }
+    }
+}
+
+/*Next nibble of the packed cave, high nibble first*/
+static unsigned char packNibble() {
+    if (packLow) {
+        packLow = 0;
+        return *packNext++ & 0x0F;
+    }
+    packLow = 1;
+    return *packNext >> 4;
+}
+
+/*Packed cave, its start row and column first*/
+const unsigned char* findCave(unsigned char cv) {
+    i2 = (cv << 1) + 1;
+    return CLM_DATA_CAVES + (CLM_DATA_CAVES[i2] | (CLM_DATA_CAVES[i2 + 1] << 8));
+}
+
+/*Rebuild cave - decode it all at once and make it the current one*/
+void rebuildCaveElementArray(unsigned char cv) {
+    clmPrepareCave(cv, clmScreen);
+    while (clmPrepareStep(255) != 0) {
+    }
+    takeCave();
+}
+
+/*Start decoding a cave into the staging area and painting it to screen*/
+void clmPrepareCave(unsigned char cv, unsigned char* screen) {
+
+    /*Point to the cave beginning, the miner is placed there*/
+    packNext = findCave(cv);
+    packLow = 0;
+    prepared.minerY = *packNext++;
+    prepared.minerX = *packNext++;
+
+    /*Reset number of diamonds and broken rocks in the cave*/
+    prepared.diamondsInCave = 0;
+    prepared.brokenCount = 0;
+
+    decodeElement = prepared.caveElements;
+    decodeScreen = screen;
+    decodeDiamond = 0;
+    clmPreparedCave = cv;
+}
+
+/*Decode the next codes of the cave, until at least the given number of
+ *cells are written, and paint them in the same pass. No code expands to
+ *more than 19 elements
+ */
+unsigned char clmPrepareStep(unsigned char cells) {
+
+    /*Screen pointer*/
+    unsigned char* s = decodeScreen;
+
+    /*Element array pointer, where this call stops and the end*/
+    unsigned char* e = decodeElement;
+    unsigned char* stop;
+    unsigned char* end = prepared.caveElements + CAVE_CELLS;
+
+    /*Elements to write for the current code*/
+    unsigned char run;
+
+    if (end - e <= cells) {
+        if (e == end) return 0;
+        stop = end;
+    } else {
+        stop = e + cells;
+    }
+
+    while (e < stop) {
+
+        z1 = packNibble();
+
+        /*Copy from the row above*/
+        if (z1 == PACK_COPY) {
+            run = packNibble() + PACK_COPY_MIN;
+            do {
+                x1 = e[-CAVE_WIDTH];
+                if (x1 == E_ROCK_BROKEN_F) addRocks(e, 1);
+                *e++ = x1;
+                x1 = elem2CharMap[x1];
+                *s++ = x1;
+                *s++ = x1 + 1;
+            } while (--run);
+            continue;
+        }
+
+        /*Repeat the element before or translate a new one*/
+        run = 1;
+        if (z1 == PACK_REPEAT_2) {
+            run = 2;
+            z1 = e[-1];
+        } else if (z1 == PACK_REPEAT_3) {
+            run = 3;
+            z1 = e[-1];
+        } else if (z1 == PACK_RUN) {
+            run = packNibble() + PACK_RUN_MIN;
+            z1 = e[-1];
+        } else if (z1 == EXT_E_DIAM) {
+            prepared.diamondsInCave++;
+            if (++decodeDiamond == 3) decodeDiamond = 0;
+            z1 = E_DIAM_F + decodeDiamond;
+        } else if (z1 == EXT_E_ROCK_BROKEN) {
+            z1 = E_ROCK_BROKEN_F;
+        }
+
+        if (z1 == E_ROCK_BROKEN_F) addRocks(e, run);
+        x1 = elem2CharMap[z1];
+        do {
+            *e++ = z1;
+            *s++ = x1;
+            *s++ = x1 + 1;
+        } while (--run);
+    }
+
+    decodeScreen = s;
+    decodeElement = e;
+    return e != end;
+}
+
+/*Make the cave in the staging area the current one, its status aside*/
+void takeCave() {
+
+    memcpy(clm.caveElements, prepared.caveElements, CAVE_CELLS);
+
+    /*Solid rock below the cave*/
+    memset(clm.caveElements + CAVE_CELLS, E_ROCK_FULL, CAVE_WIDTH);
+
+    clm.brokenCount = prepared.brokenCount;
+    memcpy(clm.brokenCell, prepared.brokenCell, prepared.brokenCount * sizeof (clm.brokenCell[0]));
+    memset(clm.brokenTicks, 0, prepared.brokenCount);
+    memset(clm.brokenDecaying, 0, prepared.brokenCount);
+
+    clm.diamondsInCave = prepared.diamondsInCave;
+    clm.minerX = prepared.minerX;
+    clm.minerY = prepared.minerY;
+    clmPreparedCave = CLM_NO_CAVE;
+}
+
+/*Note broken rocks the decoder writes, run of them from e on*/
+void addRocks(const unsigned char* e, unsigned char run) {
+    i2 = e - prepared.caveElements;
+    do {
+        if (prepared.brokenCount == CLM_BROKEN_SIZE) return;
+        prepared.brokenCell[prepared.brokenCount] = i2++;
+        ++prepared.brokenCount;
+    } while (--run);
+}
+
+/*The broken rock in a cell, brokenCount if there is none. The last one
+ *found is tried first, it is usually the one the miner still stands on
+ */
+unsigned char findRock(unsigned int cell) {
+    unsigned char r;
+
+    if (lastRock < clm.brokenCount && clm.brokenCell[lastRock] == cell) return lastRock;
+    for (r = 0; r != clm.brokenCount; ++r) {
+        if (clm.brokenCell[r] == cell) break;
+    }
+    lastRock = r;
+    return r;
+}
+
+/*Mark a broken rock to decay in this frame, brokenCount marks none*/
+void markRock(unsigned char r) {
+    if (r == clm.brokenCount || clm.brokenDecaying[r]) return;
+    clm.brokenDecaying[r] = 1;
+    ++rocksMarked;
+}
+
+/*One frame of decay over the broken rock table. Every rock marked takes
+ *a tick and the marks are cleared, so any number of rocks can crumble in
+ *the same frame. Nothing is looked at when none is marked
+ */
+void decayRocks() {
+    unsigned char r;
+
+    if (rocksMarked == 0) return;
+    for (r = 0; r != clm.brokenCount; ++r) {
+        if (clm.brokenDecaying[r]) {
+            clm.brokenDecaying[r] = 0;
+            decayRock(r);
+        }
+    }
+    rocksMarked = 0;
+}
+
+/*One frame of decay of a broken rock, with ticks of its own*/
+void decayRock(unsigned char r) {
+    if (++clm.brokenTicks[r] != clm.brokenSpeed) return;
+
+    clm.brokenTicks[r] = 0;
+    i2 = clm.brokenCell[r];
+    if (clm.caveElements[i2] < E_ROCK_BROKEN_L) {
+        ++clm.caveElements[i2];
+    } else {
+        clm.caveElements[i2] = E_BLANK;
+    }
+    paintCell(i2, clm.caveElements[i2]);
+}
+
+void adjustGameSpeed(unsigned char speed) {
+
+    clm.gameSpeed = speed;
+
+    /*Normal game speed*/
+    if (speed == GAME_SPEED_NORMAL) {
+
+        clm.brokenSpeed = 17;
+        clm.highJumpPath = JUMP_PATH_HIGH_NORMAL;
+        clm.controlDelay = 8;
+        clm.fallSpeed = 4;
+
+    }/*Slower game speed*/
+    else {
+        clm.brokenSpeed = 25;
+        clm.highJumpPath = JUMP_PATH_HIGH_SLOW;
+        clm.controlDelay = 8;
+        clm.fallSpeed = 5;
+    }
+
+}
+
+/*Rows above, at and below the miner. Needed again whenever minerY changes*/
+void locateMiner() {
+    rowHere = clm.caveElements + clmCellRow[clm.minerY];
+    rowAbove = rowHere - CAVE_WIDTH;
+    rowBelow = rowHere + CAVE_WIDTH;
+}
+
+/*Move commands with range and pass checking*/
+unsigned char moveLeft() {
+    if (clm.minerX == 0 || !(elemAttr[rowHere[clm.minerX - 1]] & A_PASSABLE)) return 0;
+    clm.minerX--;
+    checkTreasure();
+    clm.mvDelay = clm.controlDelay;
+    return 1;
+}
+
+unsigned char moveRight() {
+    if (clm.minerX == 19 || !(elemAttr[rowHere[clm.minerX + 1]] & A_PASSABLE)) return 0;
+    clm.minerX++;
+    checkTreasure();
+    clm.mvDelay = clm.controlDelay;
+    return 1;
+}
+
+void moveDown() {
+    if (clm.minerY == 21) return;
+    if (elemAttr[rowBelow[clm.minerX]] & A_PASSABLE) {
+        clm.minerY++;
+        locateMiner();
+        checkTreasure();
+        clm.mvDelay = clm.controlDelay;
+    }
+}
+
+void fallDown() {
+    if (clm.minerY == 21) return;
+    if (elemAttr[rowBelow[clm.minerX]] & A_PASSABLE) {
+        clm.minerY++;
+        locateMiner();
+        checkTreasure();
+    }
+}
+
+void moveUp() {
+    if (clm.minerY == 0) return;
+    x1 = elemAttr[rowAbove[clm.minerX]];
+    /*Not free*/
+    if (!(x1 & A_PASSABLE)) return;
+
+    /*We can move up only when we are on the ladder a passable element is above*/
+    if (rowHere[clm.minerX] == E_LADDER) {
+        /*Into death*/
+        if (x1 & A_DEATH_ABOVE) {
+            clm.stayHere = 0;
+            clm.caveDeath = 1;
+            return;
+        }
+        clm.minerY--;
+        locateMiner();
+        checkTreasure();
+        clm.mvDelay = clm.controlDelay;
+
+    }
+
+}
+
+unsigned char jumpUp() {
+    if (clm.minerY == 0) return 0;
+    x1 = elemAttr[rowAbove[clm.minerX]];
+    /*Into death*/
+    if (x1 & A_DEATH_ABOVE) {
+        clm.stayHere = 0;
+        clm.caveDeath = 1;
+        return 1;
+    }
+    /*Not free*/
+    if (!(x1 & A_PASSABLE)) return 0;
+
+    clm.minerY--;
+    locateMiner();
+    checkTreasure();
+    return 0;
+}
+
+/*Set off along a jump path*/
+void startJump(unsigned char type, unsigned char path) {
+    clm.jumpType = type;
+    clm.jumpPhase = path;
+    clm.jumpSideMoved = 0;
+    jumpMove();
+}
+
+/*Next move of the jump, then wait for the one after*/
+unsigned char jumpMove() {
+
+    switch (jumpPaths[clm.jumpPhase]) {
+        case JM_UP:
+        {
+            if (jumpUp()) {
+                endJump();
+                return 1;
+            }
+            break;
+        }
+        case JM_SIDE:
+        {
+            if (clm.jumpType == JUMP_RIGHT) {
+                moveRight();
+            } else {
+                moveLeft();
+            }
+            break;
+        }
+        default:
+        {
+            endJump();
+            return 1;
+        }
+    }
+    clm.jumpTicks = jumpPaths[clm.jumpPhase + 1];
+    clm.jumpPhase += 2;
+    return 0;
+}
+
+/*One frame of a jump in progress*/
+void advanceJump(unsigned char input) {
+
+    if (--clm.jumpTicks == 0 && jumpMove()) return;
+
+    /*Medium jumps are not steered*/
+    if (clm.jumpType != JUMP_HIGH || clm.mvDelay != 0) return;
+
+    /*Allow only single left or right move during the jump*/
+    switch (input & (JS_LOG_LEFT | JS_LOG_RIGHT)) {
+        case (JS_LOG_LEFT):
+        {
+            if (clm.jumpSideMoved) break;
+            if (moveLeft()) clm.jumpSideMoved = 1;
+            break;
+        }
+        case (JS_LOG_RIGHT):
+        {
+            if (clm.jumpSideMoved) break;
+            if (moveRight()) clm.jumpSideMoved = 1;
+            break;
+        }
+    }/*End of switch input*/
+}
+
+/*Jump is ended*/
+void endJump() {
+    /*Check for death*/
+    checkDeath();
+    clm.jumpType = JUMP_NONE;
+}
+
+void checkDeath() {
+    if (elemAttr[rowBelow[clm.minerX]] & A_DEATH_BELOW) {
+        clm.stayHere = 0;
+        clm.caveDeath = 1;
+    }
+}
+
+/*Note a cell of the cave before it changes, see clmRestartCave()*/
+void logCell(unsigned char x, unsigned char y, unsigned char elem) {
+    if (clm.undoCount > CLM_UNDO_SIZE) return;
+    if (clm.undoCount != CLM_UNDO_SIZE) {
+        clm.undoX[clm.undoCount] = x;
+        clm.undoY[clm.undoCount] = y;
+        clm.undoElement[clm.undoCount] = elem;
+    }
+    ++clm.undoCount;
+}
+
+unsigned char checkTreasure() {
+    if (elemAttr[rowHere[clm.minerX]] & A_DIAMOND) {
+        clm.diamondsCollected++;
+        logCell(clm.minerX, clm.minerY, rowHere[clm.minerX]);
+        rowHere[clm.minerX] = E_BLANK;
+        paintElement(clm.minerX, clm.minerY, E_BLANK);
+        rmtPlayDiamond();
+        if (clm.diamondsCollected == clm.diamondsInCave) {
+            clm.stayHere = 0;
+            clm.caveAllPicked = 1;
+        }
+        return 1;
+    }
+    return 0;
+}
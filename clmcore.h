@@ -0,0 +1,269 @@
+/* Curse of the lost miner - hardware independent game core.
+ *
+ * Everything that decides gameplay lives here: cave decoding, gravity,
+ * rock decay, jumps, movement, treasure and death checks. The core knows
+ * nothing about POTs, RTCLOK, PMG or interrupts. It is advanced exactly
+ * one frame at a time by clmStep() with a logical input byte.
+ *
+ * The cartridge (main.c) drives the core through a thin 5200 adapter,
+ * the host tools (host/) drive the very same code on Linux.
+ */
+
+#ifndef CLMCORE_H
+#define CLMCORE_H
+
+/*Caves*/
+#define MAX_CAVE_INDEX (12)
+#define NUMBER_OF_CAVES (13)
+#define TRAINING_CAVE_INDEX (13)
+#define CAVESIZE (222)
+#define CAVE_WIDTH (20)
+#define CAVE_HEIGHT (22)
+#define CAVE_CELLS (CAVE_WIDTH * CAVE_HEIGHT)
+
+/*Control speed - frames between the steps of a medium jump*/
+#define CTRL_DELAY (5)
+
+/*Logical input. One byte per frame*/
+#define JS_LOG_CENTER (0)
+#define JS_LOG_LEFT (1)
+#define JS_LOG_RIGHT (2)
+#define JS_LOG_UP (4)
+#define JS_LOG_DOWN (8)
+
+#define JS_LOG_UP_LEFT  (5)
+#define JS_LOG_UP_RIGHT (6)
+
+#define JS_LOG_DIRECTIONS (15)
+#define JS_LOG_FIRE (16)
+
+/*Keypad requests that influence the game*/
+#define KP_LOG_QUIT (32)
+#define KP_LOG_SUICIDE (64)
+
+/*Movement when miner is falling*/
+#define FALL_FLAG_NONE (0)
+#define FALL_FLAG_LEFT (1)
+#define FALL_FLAG_RIGHT (2)
+#define FALL_FLAG_LEFT_AND_RIGHT (3)
+#define FALL_FLAG_FALLING (4)
+
+/*Jump in progress*/
+#define JUMP_NONE (0)
+#define JUMP_LEFT (1)
+#define JUMP_RIGHT (2)
+#define JUMP_HIGH (3)
+
+/*Game over type*/
+#define GAME_OVER_NONE  (0)
+#define GAME_OVER_DEATH  (1)
+#define GAME_OVER_SUCCESS  (2)
+#define GAME_OVER_USER_QUIT (3)
+
+/*Game type*/
+#define GAME_TYPE_NORMAL (0)
+#define GAME_TYPE_TRAINING (1)
+
+/*Game speed*/
+#define GAME_SPEED_NORMAL (0)
+#define GAME_SPEED_SLOW (1)
+
+/*Cave elements*/
+
+/*These elements do not require translation*/
+#define E_BLANK (0)
+#define E_ROCK_FULL (1)
+#define E_ROCK_TL (2)
+#define E_ROCK_TR (3)
+#define E_ROCK_BL (4)
+#define E_ROCK_BR (5)
+#define E_ROCK_UNSTABLE (6)
+#define E_LADDER (7)
+#define E_DEATH_BOTTOM_TOP (8)
+#define E_DEATH_TOP_BOTTOM (9)
+
+/*Diamonds. In external representation, there is one code.
+ *Internally, we have three types of diamonds
+ */
+#define EXT_E_DIAM (14)
+#define E_DIAM_F (10)
+#define E_DIAM_L (12)
+
+/*Broken rock has one external code and 8 internals for different
+ states of decay
+ */
+#define EXT_E_ROCK_BROKEN (15)
+#define E_ROCK_BROKEN_F (13)
+#define E_ROCK_BROKEN_L (20)
+
+/*The skull is a display-only element*/
+#define E_SKULL (21)
+#define E_SKULL_2 (22)
+
+/*Broken rocks a cave may have, clmpack checks the caves against it*/
+#define CLM_BROKEN_SIZE (40)
+
+/*Cells the undo log of a cave holds, see clmRestartCave()*/
+#define CLM_UNDO_SIZE (64)
+
+/*Storage of the core state. The host tools run one game per thread*/
+#ifdef __CC65__
+#define CLM_TLS
+#else
+#define CLM_TLS _Thread_local
+#endif
+
+/*Low 16 bits of an address*/
+#ifdef __CC65__
+#define CLM_ADDR(p) ((unsigned int) (p))
+#else
+#define CLM_ADDR(p) ((unsigned int) (unsigned long) (p))
+#endif
+
+/*Complete state of a game in progress*/
+typedef struct {
+
+    /*Game*/
+    unsigned char gameType;
+    unsigned char gameSpeed;
+    unsigned char gameOverType;
+    unsigned char currentCave;
+    unsigned char lives;
+
+    /*Movement speed setup. The higher the number, the slower the movement*/
+    unsigned char brokenSpeed;
+    unsigned char highJumpPath; /*Where the high jump starts in the jump paths*/
+    unsigned char controlDelay;
+    unsigned char fallSpeed;
+
+    /*Current cave status, row after row. A row of rock lies below the cave*/
+    unsigned char caveElements[CAVE_CELLS + CAVE_WIDTH];
+
+    /*Broken rocks of the cave row after row, as they are decoded: the
+     *cell, the frames the rock has been stood on since it last crumbled
+     *and whether it decays in the frame being stepped. How far it has
+     *crumbled is its element
+     */
+    unsigned char brokenCount;
+    unsigned int brokenCell[CLM_BROKEN_SIZE];
+    unsigned char brokenTicks[CLM_BROKEN_SIZE];
+    unsigned char brokenDecaying[CLM_BROKEN_SIZE];
+
+    unsigned char diamondsInCave;
+    unsigned char diamondsCollected;
+
+    /*Cave outcome*/
+    unsigned char stayHere;
+    unsigned char caveDeath;
+    unsigned char caveAllPicked;
+    unsigned char caveQuit;
+
+    /*Miner location*/
+    unsigned char minerX;
+    unsigned char minerY;
+
+    /*Movement delay in frames*/
+    unsigned char mvDelay;
+
+    /*Gravity*/
+    unsigned char fallCounter;
+    unsigned char fallLength;
+    unsigned char fallMovementFlags;
+    unsigned char landLock;
+
+    /*Jump in progress. jumpPhase is the next move in the jump paths,
+     *jumpTicks the frames until it is made
+     */
+    unsigned char jumpType;
+    unsigned char jumpPhase;
+    unsigned char jumpTicks;
+    unsigned char jumpSideMoved;
+
+    /*Undo log - the diamonds and unstable rocks gone since the cave was
+     *entered, each with the element it had then. An undoCount past CLM_UNDO_SIZE means the
+     *log ran over and the cave has to be decoded again
+     */
+    unsigned char undoCount;
+    unsigned char undoX[CLM_UNDO_SIZE];
+    unsigned char undoY[CLM_UNDO_SIZE];
+    unsigned char undoElement[CLM_UNDO_SIZE];
+
+} ClmState;
+
+extern CLM_TLS ClmState clm;
+
+/*Index of a cell in caveElements*/
+extern const unsigned int clmCellRow[CAVE_HEIGHT + 1];
+#define CLM_CELL(x, y) (clmCellRow[y] + (x))
+
+/*Cave display memory (22 rows of 40 characters) the core paints into,
+ *the 40 characters of the status bar follow
+ */
+extern CLM_TLS unsigned char* clmScreen;
+
+/*Paint queue. While clmPaintQueued is set, paintElement() queues a cell
+ *as its screen address and first character, the second character is the
+ *next one. The platform writes the cells from clmPaintTail to
+ *clmPaintHead, the cartridge in the vertical blank; each side writes only
+ *its own index. A cell that finds the queue full is written at once, so
+ *a cell must not be painted twice with different elements before the
+ *queue is written. The core paints a cell at most once a frame, except
+ *in clmStartCave() and clmRestartCave(), which write at once and need
+ *the queue empty. The addresses are 16 bits, the host tools leave the
+ *queue off
+ */
+#define CLM_PAINT_QUEUE_SIZE (16)
+extern CLM_TLS unsigned char clmPaintQueued;
+extern CLM_TLS unsigned char clmPaintHead;
+extern CLM_TLS unsigned char clmPaintTail;
+extern CLM_TLS unsigned char clmPaintLo[CLM_PAINT_QUEUE_SIZE];
+extern CLM_TLS unsigned char clmPaintHi[CLM_PAINT_QUEUE_SIZE];
+extern CLM_TLS unsigned char clmPaintChar[CLM_PAINT_QUEUE_SIZE];
+
+/*Packed caves (levels.pak, made from levels.dat by host/clmpack): the
+ *number of caves, a table of 16-bit cave offsets, then per cave the start
+ *row and column and a nibble stream of elements and these codes
+ */
+#define PACK_REPEAT_2 (10) /*Element before twice more*/
+#define PACK_REPEAT_3 (11) /*Element before three times more*/
+#define PACK_COPY (12) /*Next nibble + PACK_COPY_MIN elements from the row above*/
+#define PACK_RUN (13) /*Element before next nibble + PACK_RUN_MIN times more*/
+#define PACK_COPY_MIN (2)
+#define PACK_RUN_MIN (4)
+
+extern unsigned char CLM_DATA_CAVES[];
+
+/*Next cave, decoded ahead while the current one is played.
+ *clmPrepareCave() starts a cave in a staging area, each clmPrepareStep()
+ *decodes about the cells given more, paints them to the screen given
+ *and returns 0 when the cave is complete. clmEnterCave() then takes it as
+ *the current cave, which is a copy. clmPreparedCave is the cave in the
+ *staging area, CLM_NO_CAVE when there is none; clmStartCave() and
+ *clmRestartCave() use the area too and leave none
+ */
+#define CLM_NO_CAVE (0xFF)
+extern CLM_TLS unsigned char clmPreparedCave;
+void clmPrepareCave(unsigned char cv, unsigned char* screen);
+unsigned char clmPrepareStep(unsigned char cells);
+
+/*Game flow*/
+void clmNewGame(unsigned char type, unsigned char startCave, unsigned char speed);
+void clmStartCave(void);
+void clmRestartCave(void); /*Same cave again after a death, repaints only what changed*/
+void clmEnterCave(void); /*The current cave, prepared to the end*/
+unsigned char clmStep(unsigned char input); /*Returns 0 when the cave is over*/
+unsigned char clmEndCave(void); /*Returns game over type*/
+unsigned char clmMinerAtRest(void); /*Standing, not jumping, input read next frame*/
+
+/*Caves and cave elements*/
+void paintElement(unsigned char x, unsigned char y, unsigned char elem);
+void paintCave(void);
+void rebuildCaveElementArray(unsigned char cv); /*Also paints the cave*/
+void updateStatusBar(void);
+
+/*Sound effects - provided by the platform*/
+void rmtPlayDiamond(void);
+void rmtPlayPicked(void);
+void rmtPlayJump(void);
+
+#endif
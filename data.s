@@ -10,7 +10,24 @@ _CLM_DATA_CHSET1:
 _CLM_DATA_CHSET2:
 .incbin "clmfont2.fnt"
 
-; Display list for caves
+; Raster Music Tracker tables. The frequency table must start a page,
+; rmt_player.s reads it through a pointer with only the low byte set
+_CLM_RMT_VOLUME:
+.incbin "rmt_volume.bin"
+_CLM_RMT_FREQ:
+.incbin "rmt_freq.bin"
+.assert <_CLM_RMT_FREQ = 0, lderror, "RMT frequency table does not start a page"
+
+; Animated tiles - glyphs of the other frames of both fonts
+.include "fontanim.s"
+
+; Display lists for caves, one for each cave display memory. A cave is
+; painted into the one not shown. main.c copies them to RAM (MA_CAVEDL and
+; MA_CAVEDL2) and sets a DLI on the row above each band of the cave. The
+; status bar DLIs come on blank lines, the one before it on the seventh of
+; eight
+CAVE_DL = 9120
+CAVE_DL2 = 9160
 ;.segment "CL_CAV_DL"
 _CLM_DATA_DL_CAVE:
 
@@ -19,37 +36,90 @@ _CLM_DATA_DL_CAVE:
 .byte 068 ,0 ,24
 .byte 004 ,004 ,004 ,004 ,004 ,004 ,004 ,004 ,004 ,004 ,004 ,004 ,004 ,004 ,004
 .byte 004 ,004 ,004 ,004 ,004 ,004
-.byte 240
+.byte 224 ,000
 .byte 066 ,112,27
 .byte 128
 .byte 065
-.byte <_CLM_DATA_DL_CAVE,>_CLM_DATA_DL_CAVE
+.byte <CAVE_DL,>CAVE_DL
+
+_CLM_DATA_DL_CAVE2:
+.byte 112 ,112 ,112
+.byte 068 ,0 ,32
+.byte 004 ,004 ,004 ,004 ,004 ,004 ,004 ,004 ,004 ,004 ,004 ,004 ,004 ,004 ,004
+.byte 004 ,004 ,004 ,004 ,004 ,004
+.byte 224 ,000
+.byte 066 ,112,35
+.byte 128
+.byte 065
+.byte <CAVE_DL2,>CAVE_DL2
+_CLM_DATA_DL_END:
+
+; The fixed RAM of main.c, checked when linking. The C data and BSS end
+; below the PMG memory (MA_PMGSTART), the second cave display memory and
+; its status bar (MA_CAVDMEM2) below the display lists, these two apart and
+; below the animated fonts (MA_ANIMFONT), and the second font above the C
+; stack
+.import __BSS_RUN__, __BSS_SIZE__, __STACKSIZE__
+.assert __BSS_RUN__ + __BSS_SIZE__ <= 4096, lderror, "BSS runs into the PMG memory"
+.assert 8192 + 23 * 40 <= CAVE_DL, lderror, "Second cave display memory runs into the display lists"
+.assert CAVE_DL + (_CLM_DATA_DL_CAVE2 - _CLM_DATA_DL_CAVE) <= CAVE_DL2, lderror, "Cave display lists overlap"
+.assert CAVE_DL2 + (_CLM_DATA_DL_END - _CLM_DATA_DL_CAVE2) <= 9216, lderror, "Cave display lists run into the animated font"
+.assert 12288 + 3 * 1024 <= $4000 - __STACKSIZE__, lderror, "Second animated font runs into the C stack"
+
+; Looks of the caves, one for each. First the colors of the top of the
+; cave: COLPF0, COLPF1, COLPF2, COLPF3 and COLBK, in the order of their
+; shadows 12-16. Then its bands from the top, a 0 after the last. A band is
+; the row it starts at (1-21), the font page (0 the cave font, animated)
+; and the five colors. At most DLI_BANDS of main.c
+_CLM_DATA_LOOKS:
+.word lookBrown, lookBrown, lookPurple, lookPurple
+.word lookDeepBrown, lookBrown, lookPurple, lookDeepPurple
+.word lookBrown, lookBrown, lookPurple, lookPurple
+.word lookBrown, lookBrown
+
+lookBrown:
+.byte $32, 12, $96, $34, 0	;Dark brown, white, blue, lighter brown
+.byte 0
+
+lookPurple:
+.byte $54, 12, $D8, $56, 0	;Dark purple, white, green, lighter purple
+.byte 0
+
+;Darker down the cave, and still at the bottom: the last band shows the
+;font of the cave as it is in ROM, not its animated frames. The font must
+;be the one of the cave, CHSET1 for even caves, CHSET2 for odd ones
+lookDeepBrown:
+.byte $32, 12, $96, $34, 0
+.byte 9, 0, $22, 12, $94, $24, 0
+.byte 16, >_CLM_DATA_CHSET1, $12, 10, $92, $14, 0
+.byte 0
+
+lookDeepPurple:
+.byte $54, 12, $D8, $56, 0
+.byte 9, 0, $44, 12, $D6, $46, 0
+.byte 16, >_CLM_DATA_CHSET2, $34, 10, $D4, $36, 0
+.byte 0
 
 ; Levels
 ;.segment "CL_CAVES"
 _CLM_DATA_CAVES:
-.incbin "levels.dat"
+.incbin "levels.pak"
 
-;Raster Music Tracker
+;Raster Music Tracker music, played where it is
 ;.segment "RMT_ROM"
-_CLM_RMT_AUX1:
-.incbin "rmt_aux1.bin"
-_CLM_RMT_AUX2:
-.incbin "rmt_aux2.bin"
-_CLM_RMT_MAIN:
-.incbin "rmt_main.bin"
-_CLM_RMT_MUSIC:
-.incbin "rmt_music.bin"
-_CLM_RMT_MUSIC_END:
+.include "rmt_music.s"
 
 ; Export symbols to make them visible in the C program
 .export _CLM_DATA_CAVES
 .export _CLM_DATA_DL_CAVE
+.export _CLM_DATA_DL_CAVE2
+.export _CLM_DATA_LOOKS
 .export _CLM_DATA_CHSET1
 .export _CLM_DATA_CHSET2
-.export _CLM_RMT_AUX1
-.export _CLM_RMT_AUX2
-.export _CLM_RMT_MAIN
+.export _CLM_ANIM_CHARS
+.export _CLM_ANIM_CHSET1
+.export _CLM_ANIM_CHSET2
+.export _CLM_RMT_VOLUME
+.export _CLM_RMT_FREQ
 .export _CLM_RMT_MUSIC
-.export _CLM_RMT_MUSIC_END
 
@@ -0,0 +1,87 @@
+;Curse of the lost miner - animated tiles, made by clmanim from
+;clmfont1.fnt and clmfont2.fnt. Frames 1-3, frame 0 is the font
+
+_CLM_ANIM_CHARS:
+.byte 84,85,86,87,88,89,66,67,76,77,78,79,0
+
+_CLM_ANIM_CHSET1:
+;Frame 1
+.byte $02,$0A,$2B,$3B,$3B,$3B,$0E,$03
+.byte $C0,$F0,$FC,$FC,$FC,$CC,$F0,$C0
+.byte $02,$0B,$2F,$3F,$3F,$3E,$0E,$03
+.byte $C0,$B0,$EC,$EC,$AC,$BC,$B0,$C0
+.byte $02,$0A,$2F,$3F,$3F,$3F,$0F,$03
+.byte $C0,$B0,$AC,$AC,$EC,$EC,$B0,$C0
+.byte $83,$8E,$CA,$EA,$AA,$55,$7F,$FF
+.byte $02,$8A,$8A,$AA,$AA,$55,$5D,$FF
+.byte $D7,$5D,$FA,$EA,$AA,$A8,$88,$80
+.byte $D7,$7D,$AA,$AA,$2A,$2A,$08,$00
+.byte $FF,$C0,$FF,$C0,$FF,$C0,$FF,$C0
+.byte $FF,$03,$FF,$03,$FF,$03,$FF,$03
+;Frame 2
+.byte $03,$0E,$3B,$3A,$3A,$2B,$0E,$03
+.byte $C0,$E0,$AC,$BC,$FC,$CC,$F0,$C0
+.byte $03,$0F,$3F,$3E,$3A,$2A,$0E,$03
+.byte $C0,$A0,$AC,$AC,$AC,$BC,$B0,$C0
+.byte $03,$0E,$3F,$3E,$3A,$2B,$0F,$03
+.byte $C0,$A0,$AC,$AC,$EC,$EC,$B0,$C0
+.byte $82,$8A,$8A,$AB,$AF,$55,$7F,$FF
+.byte $03,$8E,$CA,$EA,$AA,$55,$5D,$FF
+.byte $D7,$5D,$AA,$AB,$AF,$BC,$C8,$C0
+.byte $D7,$7D,$FA,$EA,$2A,$2A,$08,$00
+.byte $C0,$FF,$C0,$FF,$C0,$FF,$C0,$FF
+.byte $03,$FF,$03,$FF,$03,$FF,$03,$FF
+;Frame 3
+.byte $03,$0E,$3B,$3B,$3B,$3B,$0E,$02
+.byte $C0,$F0,$FC,$FC,$F8,$C8,$A0,$80
+.byte $03,$0F,$3F,$3F,$3F,$3E,$0E,$02
+.byte $C0,$B0,$EC,$EC,$A8,$A8,$A0,$80
+.byte $03,$0E,$3F,$3F,$3F,$3F,$0F,$02
+.byte $C0,$B0,$AC,$AC,$E8,$E8,$A0,$80
+.byte $82,$8A,$8A,$AA,$AA,$55,$7F,$FF
+.byte $02,$8A,$8A,$AB,$AF,$55,$5D,$FF
+.byte $D7,$5D,$AA,$AA,$AA,$A8,$88,$80
+.byte $D7,$7D,$AA,$AB,$2F,$3E,$08,$00
+.byte $FF,$C0,$FF,$C0,$FF,$C0,$FF,$C0
+.byte $FF,$03,$FF,$03,$FF,$03,$FF,$03
+
+_CLM_ANIM_CHSET2:
+;Frame 1
+.byte $00,$02,$0B,$0B,$0B,$0B,$02,$00
+.byte $00,$80,$E0,$E0,$A0,$A0,$80,$00
+.byte $00,$03,$0F,$3F,$3F,$0E,$03,$00
+.byte $00,$C0,$B0,$EC,$EC,$B0,$C0,$00
+.byte $00,$03,$0E,$3B,$3A,$0E,$03,$00
+.byte $00,$C0,$B0,$EC,$AC,$B0,$C0,$00
+.byte $0C,$8C,$C8,$C8,$88,$88,$55,$FD
+.byte $80,$88,$88,$88,$88,$88,$55,$7F
+.byte $FD,$55,$C8,$C8,$88,$88,$88,$08
+.byte $7F,$55,$88,$88,$88,$88,$88,$80
+.byte $3F,$30,$30,$3F,$3F,$30,$30,$3F
+.byte $FC,$0C,$0C,$FC,$FC,$0C,$0C,$FC
+;Frame 2
+.byte $00,$02,$0B,$0A,$0A,$0B,$02,$00
+.byte $00,$80,$A0,$A0,$A0,$A0,$80,$00
+.byte $00,$03,$0F,$3E,$3A,$0A,$03,$00
+.byte $00,$C0,$A0,$AC,$EC,$B0,$C0,$00
+.byte $00,$03,$0E,$3A,$3A,$0A,$03,$00
+.byte $00,$C0,$A0,$AC,$AC,$B0,$C0,$00
+.byte $08,$88,$88,$88,$8C,$8C,$55,$FD
+.byte $80,$8C,$C8,$C8,$88,$88,$55,$7F
+.byte $FD,$55,$88,$88,$8C,$8C,$C8,$08
+.byte $7F,$55,$C8,$C8,$88,$88,$88,$80
+.byte $3F,$3F,$30,$30,$3F,$3F,$30,$30
+.byte $FC,$FC,$0C,$0C,$FC,$FC,$0C,$0C
+;Frame 3
+.byte $00,$02,$0B,$0B,$0B,$0B,$02,$00
+.byte $00,$80,$E0,$E0,$A0,$A0,$80,$00
+.byte $00,$03,$0F,$3F,$3F,$0E,$03,$00
+.byte $00,$C0,$B0,$EC,$E8,$A0,$80,$00
+.byte $00,$03,$0E,$3B,$3A,$0E,$03,$00
+.byte $00,$C0,$B0,$EC,$A8,$A0,$80,$00
+.byte $08,$88,$88,$88,$88,$88,$55,$FD
+.byte $80,$88,$88,$88,$8C,$8C,$55,$7F
+.byte $FD,$55,$88,$88,$88,$88,$88,$08
+.byte $7F,$55,$88,$88,$8C,$8C,$C8,$C0
+.byte $30,$3F,$3F,$30,$30,$3F,$3F,$30
+.byte $0C,$FC,$FC,$0C,$0C,$FC,$FC,$0C
@@ -0,0 +1,767 @@
+/* Curse of the lost miner - headless Atari 5200 stand-in.
+ * See a5200.h.
+ */
+
+#include <string.h>
+
+#include "a5200.h"
+
+/*Status register*/
+#define FLAG_C (0x01)
+#define FLAG_Z (0x02)
+#define FLAG_I (0x04)
+#define FLAG_D (0x08)
+#define FLAG_B (0x10)
+#define FLAG_U (0x20)
+#define FLAG_V (0x40)
+#define FLAG_N (0x80)
+
+/*What answers at an address, by page*/
+#define PAGE_RAM (0)
+#define PAGE_ROM (1)
+#define PAGE_GTIA (2)
+#define PAGE_ANTIC (3)
+#define PAGE_POKEY (4)
+#define PAGE_NONE (5)
+
+static unsigned char pageKind[256];
+
+/*RAM vectors and shadow registers the BIOS uses*/
+#define POKMSK (0x00)
+#define VIMIRQ (0x200)
+#define VVBLKI (0x202)
+#define VVBLKD (0x204)
+#define VDSLST (0x206)
+#define VKYBDI (0x208)
+#define VKYBDF (0x20A)
+#define VTRIGR (0x20C)
+#define VBRKOP (0x20E)
+
+/*The BIOS stand-in, assembled by hand, at $FC00*/
+#define BIOS_BASE (0xFC00)
+#define BIOS_NMI A5200_BIOS_NMI
+#define BIOS_IMMEDIATE_VBI A5200_BIOS_IMMEDIATE_VBI
+#define BIOS_IRQ A5200_BIOS_IRQ
+#define BIOS_IRQ_DISPATCH A5200_BIOS_IRQ_DISPATCH
+#define BIOS_KEYBOARD A5200_BIOS_KEYBOARD
+#define BIOS_IRQ_EXIT (0xFC7F)
+#define BIOS_BREAK (0xFC81)
+#define BIOS_DLI (0xFC83)
+#define BIOS_EXIT A5200_BIOS_EXIT
+
+static const unsigned char biosCode[] = {
+    /*FC00 NMI*/
+    0x2C, 0x0F, 0xD4, /*BIT NMIST*/
+    0x10, 0x03, /*BPL FC08*/
+    0x6C, 0x06, 0x02, /*JMP (VDSLST)*/
+    0x48, 0x8A, 0x48, 0x98, 0x48, /*PHA TXA PHA TYA PHA*/
+    0x8D, 0x0F, 0xD4, /*STA NMIRES*/
+    0x6C, 0x02, 0x02, /*JMP (VVBLKI)*/
+
+    /*FC13 Immediate VBI*/
+    0xE6, 0x02, /*INC RTCLOK+1*/
+    0xD0, 0x02, /*BNE FC19*/
+    0xE6, 0x01, /*INC RTCLOK*/
+    0xA5, 0x05, 0x8D, 0x02, 0xD4, /*SDLSTL to DLISTL*/
+    0xA5, 0x06, 0x8D, 0x03, 0xD4, /*SDLSTH to DLISTH*/
+    0xA5, 0x07, 0x8D, 0x00, 0xD4, /*SDMCTL to DMACTL*/
+    0xA2, 0x08, /*LDX #8*/
+    0xB5, 0x08, 0x9D, 0x12, 0xC0, /*PCOLR0,X to COLPM0,X*/
+    0xCA, 0x10, 0xF8, /*DEX BPL FC2A*/
+    0xA2, 0x07, /*LDX #7*/
+    0xBD, 0x00, 0xE8, 0x95, 0x11, /*POT0,X to PADDL0,X*/
+    0xCA, 0x10, 0xF8, /*DEX BPL FC34*/
+    0x8D, 0x0B, 0xE8, /*STA POTGO*/
+    0x6C, 0x04, 0x02, /*JMP (VVBLKD)*/
+
+    /*FC42 IRQ*/
+    0x6C, 0x00, 0x02, /*JMP (VIMIRQ)*/
+
+    /*FC45 IRQ dispatch*/
+    0x48, /*PHA*/
+    0xAD, 0x0E, 0xE8, 0x29, 0x80, /*LDA IRQST AND #$80*/
+    0xD0, 0x0F, /*BNE FC5C*/
+    0xA9, 0x7F, 0x25, 0x00, 0x8D, 0x0E, 0xE8, /*Acknowledge break*/
+    0xA5, 0x00, 0x8D, 0x0E, 0xE8, /*POKMSK to IRQEN*/
+    0x6C, 0x0C, 0x02, /*JMP (VTRIGR)*/
+    0xAD, 0x0E, 0xE8, 0x29, 0x40, /*LDA IRQST AND #$40*/
+    0xD0, 0x1C, /*BNE FC7F*/
+    0xA9, 0xBF, 0x25, 0x00, 0x8D, 0x0E, 0xE8, /*Acknowledge keyboard*/
+    0xA5, 0x00, 0x8D, 0x0E, 0xE8, /*POKMSK to IRQEN*/
+    0x8A, 0x48, 0x98, 0x48, /*TXA PHA TYA PHA*/
+    0x6C, 0x08, 0x02, /*JMP (VKYBDI)*/
+
+    /*FC76 Keyboard*/
+    0xAD, 0x09, 0xE8, /*LDA KBCODE*/
+    0x4A, 0x29, 0x0F, /*LSR AND #$0F*/
+    0x6C, 0x0A, 0x02, /*JMP (VKYBDF)*/
+
+    /*FC7F IRQ nobody asked for*/
+    0x68, 0x40, /*PLA RTI*/
+
+    /*FC81 Break key*/
+    0x68, 0x40, /*PLA RTI*/
+
+    /*FC83 DLI*/
+    0x40 /*RTI*/
+};
+
+static const unsigned char biosExit[] = {
+    /*FCB2 Exit*/
+    0x68, 0xA8, 0x68, 0xAA, 0x68, 0x40 /*PLA TAY PLA TAX PLA RTI*/
+};
+
+/*Scanlines per mode line and playfield bytes per line at normal width*/
+static const unsigned char modeLines[16] = {0, 0, 8, 10, 8, 16, 8, 16, 8, 4, 4, 2, 1, 2, 1, 1};
+static const unsigned char modeBytes[16] = {0, 0, 40, 40, 40, 40, 20, 20, 10, 10, 20, 20, 20, 40, 40, 40};
+
+/*Memory*/
+
+static unsigned char ioRead(A5200* m, unsigned char kind, unsigned short addr) {
+    switch (kind) {
+        case PAGE_GTIA:
+            addr &= 0x1F;
+            if (addr == 0x10) return m->input.trigger ? 0 : 1;
+            if (addr >= 0x11 && addr <= 0x13) return 1;
+            if (addr < 0x10) return 0; /*No collisions*/
+            return 0x0F;
+
+        case PAGE_ANTIC:
+            switch (addr & 0x0F) {
+                case 0x0B: return (unsigned char) (m->line >> 1);
+                case 0x0F: return m->nmist | 0x1F;
+                default: return 0xFF;
+            }
+
+        case PAGE_POKEY:
+            addr &= 0x0F;
+            if (addr == 0) return m->input.potX;
+            if (addr == 1) return m->input.potY;
+            if (addr < 8) return A5200_POT_MAX;
+            switch (addr) {
+                case 0x08: return 0;
+                case 0x09: return m->kbcode;
+                case 0x0A:
+                    m->random = m->random * 1103515245U + 12345U;
+                    return (unsigned char) (m->random >> 16);
+                case 0x0E: return m->irqst;
+                case 0x0F: return m->skstat;
+                default: return 0xFF;
+            }
+
+        default:
+            return 0xFF;
+    }
+}
+
+static void ioWrite(A5200* m, unsigned char kind, unsigned short addr, unsigned char v) {
+    if (m->trace && m->trace->ioWrite) m->trace->ioWrite(m->traceCtx, m, addr, v);
+
+    switch (kind) {
+        case PAGE_ANTIC:
+            switch (addr & 0x0F) {
+                case 0x00: m->dmactl = v;
+                    break;
+                case 0x02: m->dlist = (m->dlist & 0xFF00) | v;
+                    break;
+                case 0x03: m->dlist = (m->dlist & 0x00FF) | (v << 8);
+                    break;
+                case 0x07: m->pmbase = v;
+                    break;
+                case 0x09: m->chbase = v;
+                    break;
+                case 0x0A:
+                    m->wsync = 1;
+                    if (m->dliLine >= 0 && !m->dliSynced) {
+                        m->dliSynced = 1;
+                        if (m->line != m->dliLine) m->dliLate++;
+                    }
+                    break;
+                case 0x0E: m->nmien = v;
+                    break;
+                case 0x0F: m->nmist = 0;
+                    break;
+            }
+            break;
+
+        case PAGE_POKEY:
+            if ((addr & 0x0F) == 0x0E) {
+                m->irqen = v;
+                m->irqst |= (unsigned char) ~v;
+            }
+            break;
+    }
+}
+
+static inline unsigned char rd(A5200* m, unsigned short addr) {
+    unsigned char kind = pageKind[addr >> 8];
+
+    if (kind <= PAGE_ROM) return m->mem[addr];
+    return ioRead(m, kind, addr);
+}
+
+static inline void wr(A5200* m, unsigned short addr, unsigned char v) {
+    unsigned char kind = pageKind[addr >> 8];
+
+    if (kind == PAGE_RAM) {
+        m->mem[addr] = v;
+    } else if (kind != PAGE_ROM) {
+        ioWrite(m, kind, addr, v);
+    }
+}
+
+/*CPU helpers*/
+
+static inline unsigned char fetch(A5200* m) {
+    return m->mem[m->pc++];
+}
+
+static inline unsigned short fetch16(A5200* m) {
+    unsigned short v = m->mem[m->pc] | (m->mem[(unsigned short) (m->pc + 1)] << 8);
+
+    m->pc += 2;
+    return v;
+}
+
+static inline void push(A5200* m, unsigned char v) {
+    m->mem[0x100 + m->sp--] = v;
+}
+
+static inline unsigned char pull(A5200* m) {
+    return m->mem[0x100 + ++m->sp];
+}
+
+static inline unsigned char nz(A5200* m, unsigned char v) {
+    m->p = (m->p & ~(FLAG_N | FLAG_Z)) | (v & FLAG_N) | (v ? 0 : FLAG_Z);
+    return v;
+}
+
+static inline unsigned short zpWord(A5200* m, unsigned char zp) {
+    return m->mem[zp] | (m->mem[(unsigned char) (zp + 1)] << 8);
+}
+
+/*Indexed address, cross set to 1 if the index crossed a page*/
+static inline unsigned short indexed(unsigned short base, unsigned char i, int* cross) {
+    unsigned short ea = base + i;
+
+    *cross = (ea ^ base) >> 8 ? 1 : 0;
+    return ea;
+}
+
+static void adc(A5200* m, unsigned char v) {
+    unsigned int c = m->p & FLAG_C;
+    unsigned int sum = m->a + v + c;
+    unsigned int lo, hi;
+
+    if (m->p & FLAG_D) {
+        /*NMOS decimal mode, Z comes from the binary sum*/
+        lo = (m->a & 0x0F) + (v & 0x0F) + c;
+        if (lo > 9) lo += 6;
+        hi = (m->a >> 4) + (v >> 4) + (lo > 0x0F);
+        m->p &= ~(FLAG_N | FLAG_V | FLAG_Z | FLAG_C);
+        if ((sum & 0xFF) == 0) m->p |= FLAG_Z;
+        if (hi & 8) m->p |= FLAG_N;
+        if (~(m->a ^ v) & (m->a ^ (hi << 4)) & 0x80) m->p |= FLAG_V;
+        if (hi > 9) hi += 6;
+        if (hi > 0x0F) m->p |= FLAG_C;
+        m->a = (unsigned char) ((hi << 4) | (lo & 0x0F));
+        return;
+    }
+
+    m->p &= ~(FLAG_V | FLAG_C);
+    if (~(m->a ^ v) & (m->a ^ sum) & 0x80) m->p |= FLAG_V;
+    if (sum > 0xFF) m->p |= FLAG_C;
+    m->a = nz(m, (unsigned char) sum);
+}
+
+static void sbc(A5200* m, unsigned char v) {
+    unsigned int borrow = (m->p & FLAG_C) ? 0 : 1;
+    unsigned int diff = m->a - v - borrow;
+    int lo, hi;
+
+    m->p &= ~(FLAG_V | FLAG_C);
+    if ((m->a ^ v) & (m->a ^ diff) & 0x80) m->p |= FLAG_V;
+    if (diff < 0x100) m->p |= FLAG_C;
+    nz(m, (unsigned char) diff);
+
+    if (m->p & FLAG_D) {
+        /*NMOS decimal mode, flags as in binary mode*/
+        lo = (m->a & 0x0F) - (v & 0x0F) - (int) borrow;
+        hi = (m->a >> 4) - (v >> 4);
+        if (lo < 0) {
+            lo -= 6;
+            hi--;
+        }
+        if (hi < 0) hi -= 6;
+        m->a = (unsigned char) ((hi << 4) | (lo & 0x0F));
+        return;
+    }
+    m->a = (unsigned char) diff;
+}
+
+static inline void compare(A5200* m, unsigned char r, unsigned char v) {
+    m->p = (m->p & ~FLAG_C) | (r >= v ? FLAG_C : 0);
+    nz(m, (unsigned char) (r - v));
+}
+
+static inline unsigned char asl(A5200* m, unsigned char v) {
+    m->p = (m->p & ~FLAG_C) | (v >> 7);
+    return nz(m, (unsigned char) (v << 1));
+}
+
+static inline unsigned char lsr(A5200* m, unsigned char v) {
+    m->p = (m->p & ~FLAG_C) | (v & 1);
+    return nz(m, v >> 1);
+}
+
+static inline unsigned char rol(A5200* m, unsigned char v) {
+    unsigned char c = m->p & FLAG_C;
+
+    m->p = (m->p & ~FLAG_C) | (v >> 7);
+    return nz(m, (unsigned char) ((v << 1) | c));
+}
+
+static inline unsigned char ror(A5200* m, unsigned char v) {
+    unsigned char c = m->p & FLAG_C;
+
+    m->p = (m->p & ~FLAG_C) | (v & 1);
+    return nz(m, (unsigned char) ((v >> 1) | (c << 7)));
+}
+
+static inline int branch(A5200* m, int taken) {
+    signed char d = (signed char) fetch(m);
+    unsigned short from = m->pc;
+
+    if (!taken) return 2;
+    m->pc += d;
+    return ((from ^ m->pc) & 0xFF00) ? 4 : 3;
+}
+
+/*Take an interrupt or BRK through the vector at v*/
+static int interrupt(A5200* m, unsigned short v, unsigned char flags) {
+    unsigned char sp = m->sp;
+
+    push(m, m->pc >> 8);
+    push(m, m->pc & 0xFF);
+    push(m, (m->p & ~FLAG_B) | FLAG_U | flags);
+    m->p |= FLAG_I;
+    m->pc = m->mem[v] | (m->mem[v + 1] << 8);
+    if (m->trace && m->trace->interrupt) m->trace->interrupt(m->traceCtx, m, m->pc, sp);
+    return 7;
+}
+
+/*Operand access for the ORA AND EOR ADC STA LDA CMP SBC group*/
+#define READ_GROUP(base, OP) \
+    case base + 0x01: OP(rd(m, zpWord(m, fetch(m) + m->x))); return 6; \
+    case base + 0x05: OP(m->mem[fetch(m)]); return 3; \
+    case base + 0x09: OP(fetch(m)); return 2; \
+    case base + 0x0D: OP(rd(m, fetch16(m))); return 4; \
+    case base + 0x11: ea = indexed(zpWord(m, fetch(m)), m->y, &cross); OP(rd(m, ea)); return 5 + cross; \
+    case base + 0x15: OP(m->mem[(unsigned char) (fetch(m) + m->x)]); return 4; \
+    case base + 0x19: ea = indexed(fetch16(m), m->y, &cross); OP(rd(m, ea)); return 4 + cross; \
+    case base + 0x1D: ea = indexed(fetch16(m), m->x, &cross); OP(rd(m, ea)); return 4 + cross;
+
+/*Read-modify-write shifts, INC and DEC*/
+#define RMW_GROUP(base, OP) \
+    case base + 0x06: ea = fetch(m); m->mem[ea] = OP(m->mem[ea]); return 5; \
+    case base + 0x0E: ea = fetch16(m); wr(m, ea, OP(rd(m, ea))); return 6; \
+    case base + 0x16: ea = (unsigned char) (fetch(m) + m->x); m->mem[ea] = OP(m->mem[ea]); return 6; \
+    case base + 0x1E: ea = fetch16(m) + m->x; wr(m, ea, OP(rd(m, ea))); return 7;
+
+#define OP_ORA(v) nz(m, m->a |= (v))
+#define OP_AND(v) nz(m, m->a &= (v))
+#define OP_EOR(v) nz(m, m->a ^= (v))
+#define OP_ADC(v) adc(m, (v))
+#define OP_LDA(v) nz(m, m->a = (v))
+#define OP_CMP(v) compare(m, m->a, (v))
+#define OP_SBC(v) sbc(m, (v))
+#define OP_ASL(v) asl(m, (v))
+#define OP_ROL(v) rol(m, (v))
+#define OP_LSR(v) lsr(m, (v))
+#define OP_ROR(v) ror(m, (v))
+#define OP_DEC(v) nz(m, (unsigned char) ((v) - 1))
+#define OP_INC(v) nz(m, (unsigned char) ((v) + 1))
+
+/*Execute one instruction, return its cycles*/
+static int step(A5200* m) {
+    unsigned short at = m->pc;
+    unsigned char op = fetch(m);
+    unsigned short ea;
+    unsigned char v, sp;
+    int cross;
+
+    switch (op) {
+
+        READ_GROUP(0x00, OP_ORA)
+        READ_GROUP(0x20, OP_AND)
+        READ_GROUP(0x40, OP_EOR)
+        READ_GROUP(0x60, OP_ADC)
+        READ_GROUP(0xA0, OP_LDA)
+        READ_GROUP(0xC0, OP_CMP)
+        READ_GROUP(0xE0, OP_SBC)
+
+        RMW_GROUP(0x00, OP_ASL)
+        RMW_GROUP(0x20, OP_ROL)
+        RMW_GROUP(0x40, OP_LSR)
+        RMW_GROUP(0x60, OP_ROR)
+        RMW_GROUP(0xC0, OP_DEC)
+        RMW_GROUP(0xE0, OP_INC)
+
+        /*STA*/
+        case 0x81: wr(m, zpWord(m, fetch(m) + m->x), m->a); return 6;
+        case 0x85: m->mem[fetch(m)] = m->a; return 3;
+        case 0x8D: wr(m, fetch16(m), m->a); return 4;
+        case 0x91: wr(m, zpWord(m, fetch(m)) + m->y, m->a); return 6;
+        case 0x95: m->mem[(unsigned char) (fetch(m) + m->x)] = m->a; return 4;
+        case 0x99: wr(m, fetch16(m) + m->y, m->a); return 5;
+        case 0x9D: wr(m, fetch16(m) + m->x, m->a); return 5;
+
+        /*STX STY*/
+        case 0x86: m->mem[fetch(m)] = m->x; return 3;
+        case 0x8E: wr(m, fetch16(m), m->x); return 4;
+        case 0x96: m->mem[(unsigned char) (fetch(m) + m->y)] = m->x; return 4;
+        case 0x84: m->mem[fetch(m)] = m->y; return 3;
+        case 0x8C: wr(m, fetch16(m), m->y); return 4;
+        case 0x94: m->mem[(unsigned char) (fetch(m) + m->x)] = m->y; return 4;
+
+        /*LDX LDY*/
+        case 0xA2: nz(m, m->x = fetch(m)); return 2;
+        case 0xA6: nz(m, m->x = m->mem[fetch(m)]); return 3;
+        case 0xAE: nz(m, m->x = rd(m, fetch16(m))); return 4;
+        case 0xB6: nz(m, m->x = m->mem[(unsigned char) (fetch(m) + m->y)]); return 4;
+        case 0xBE: ea = indexed(fetch16(m), m->y, &cross); nz(m, m->x = rd(m, ea)); return 4 + cross;
+        case 0xA0: nz(m, m->y = fetch(m)); return 2;
+        case 0xA4: nz(m, m->y = m->mem[fetch(m)]); return 3;
+        case 0xAC: nz(m, m->y = rd(m, fetch16(m))); return 4;
+        case 0xB4: nz(m, m->y = m->mem[(unsigned char) (fetch(m) + m->x)]); return 4;
+        case 0xBC: ea = indexed(fetch16(m), m->x, &cross); nz(m, m->y = rd(m, ea)); return 4 + cross;
+
+        /*CPX CPY BIT*/
+        case 0xE0: compare(m, m->x, fetch(m)); return 2;
+        case 0xE4: compare(m, m->x, m->mem[fetch(m)]); return 3;
+        case 0xEC: compare(m, m->x, rd(m, fetch16(m))); return 4;
+        case 0xC0: compare(m, m->y, fetch(m)); return 2;
+        case 0xC4: compare(m, m->y, m->mem[fetch(m)]); return 3;
+        case 0xCC: compare(m, m->y, rd(m, fetch16(m))); return 4;
+        case 0x24:
+            v = m->mem[fetch(m)];
+            m->p = (m->p & ~(FLAG_N | FLAG_V | FLAG_Z)) | (v & (FLAG_N | FLAG_V)) | ((m->a & v) ? 0 : FLAG_Z);
+            return 3;
+        case 0x2C:
+            v = rd(m, fetch16(m));
+            m->p = (m->p & ~(FLAG_N | FLAG_V | FLAG_Z)) | (v & (FLAG_N | FLAG_V)) | ((m->a & v) ? 0 : FLAG_Z);
+            return 4;
+
+        /*Accumulator shifts*/
+        case 0x0A: m->a = asl(m, m->a); return 2;
+        case 0x2A: m->a = rol(m, m->a); return 2;
+        case 0x4A: m->a = lsr(m, m->a); return 2;
+        case 0x6A: m->a = ror(m, m->a); return 2;
+
+        /*Registers*/
+        case 0xAA: nz(m, m->x = m->a); return 2;
+        case 0x8A: nz(m, m->a = m->x); return 2;
+        case 0xA8: nz(m, m->y = m->a); return 2;
+        case 0x98: nz(m, m->a = m->y); return 2;
+        case 0xBA: nz(m, m->x = m->sp); return 2;
+        case 0x9A: m->sp = m->x; return 2;
+        case 0xE8: nz(m, ++m->x); return 2;
+        case 0xC8: nz(m, ++m->y); return 2;
+        case 0xCA: nz(m, --m->x); return 2;
+        case 0x88: nz(m, --m->y); return 2;
+
+        /*Flags*/
+        case 0x18: m->p &= ~FLAG_C; return 2;
+        case 0x38: m->p |= FLAG_C; return 2;
+        case 0x58: m->p &= ~FLAG_I; return 2;
+        case 0x78: m->p |= FLAG_I; return 2;
+        case 0xB8: m->p &= ~FLAG_V; return 2;
+        case 0xD8: m->p &= ~FLAG_D; return 2;
+        case 0xF8: m->p |= FLAG_D; return 2;
+        case 0xEA: return 2;
+
+        /*Stack*/
+        case 0x48: push(m, m->a); return 3;
+        case 0x08: push(m, m->p | FLAG_B | FLAG_U); return 3;
+        case 0x68: nz(m, m->a = pull(m)); return 4;
+        case 0x28: m->p = pull(m) | FLAG_U; return 4;
+
+        /*Branches*/
+        case 0x10: return branch(m, !(m->p & FLAG_N));
+        case 0x30: return branch(m, m->p & FLAG_N);
+        case 0x50: return branch(m, !(m->p & FLAG_V));
+        case 0x70: return branch(m, m->p & FLAG_V);
+        case 0x90: return branch(m, !(m->p & FLAG_C));
+        case 0xB0: return branch(m, m->p & FLAG_C);
+        case 0xD0: return branch(m, !(m->p & FLAG_Z));
+        case 0xF0: return branch(m, m->p & FLAG_Z);
+
+        /*Jumps, calls and returns*/
+        case 0x4C: m->pc = fetch16(m); return 3;
+        case 0x6C:
+            ea = fetch16(m);
+            /*The page of the pointer does not carry*/
+            m->pc = m->mem[ea] | (m->mem[(ea & 0xFF00) | ((ea + 1) & 0xFF)] << 8);
+            if (at >= BIOS_BASE && m->trace && m->trace->vectorJump) {
+                m->trace->vectorJump(m->traceCtx, m, ea, m->pc);
+            }
+            return 5;
+        case 0x20:
+            ea = fetch16(m);
+            sp = m->sp;
+            push(m, (m->pc - 1) >> 8);
+            push(m, (m->pc - 1) & 0xFF);
+            m->pc = ea;
+            if (m->trace && m->trace->call) m->trace->call(m->traceCtx, m, ea, sp);
+            return 6;
+        case 0x60:
+            m->pc = pull(m);
+            m->pc |= pull(m) << 8;
+            m->pc++;
+            if (m->trace && m->trace->ret) m->trace->ret(m->traceCtx, m, m->sp);
+            return 6;
+        case 0x40:
+            m->p = pull(m) | FLAG_U;
+            m->pc = pull(m);
+            m->pc |= pull(m) << 8;
+            if (m->dliLine >= 0 && m->sp == m->dliSp) m->dliLine = -1;
+            if (m->trace && m->trace->ret) m->trace->ret(m->traceCtx, m, m->sp);
+            return 6;
+        case 0x00:
+            m->pc++;
+            return interrupt(m, 0xFFFE, FLAG_B);
+
+        default:
+            m->illegal++;
+            return 2;
+    }
+}
+
+/*ANTIC work at the start of a scanline, returns the cycles it takes*/
+static int startLine(A5200* m) {
+    int stolen = 9; /*Memory refresh*/
+    int width = m->dmactl & 3;
+    unsigned char ins;
+
+    if (m->line == 8) {
+        m->dlLinesLeft = 0;
+        m->dlWait = 0;
+    }
+
+    if (m->line >= 8 && m->line < A5200_VBI_LINE) {
+
+        /*Next display list instruction*/
+        if (m->dlLinesLeft == 0) {
+            m->dlMode = 0;
+            m->dlDli = 0;
+            m->dlLinesLeft = 1;
+            if (!m->dlWait && (m->dmactl & 0x20)) {
+                ins = m->mem[m->dlist];
+                m->dlist = (m->dlist & 0xFC00) | ((m->dlist + 1) & 0x03FF);
+                stolen++;
+                m->dlDli = ins & 0x80;
+                m->dlMode = ins & 0x0F;
+                if (m->dlMode == 0) {
+                    m->dlLinesLeft = ((ins >> 4) & 7) + 1;
+                } else if (m->dlMode == 1) {
+                    m->dlist = m->mem[m->dlist] | (m->mem[(unsigned short) (m->dlist + 1)] << 8);
+                    stolen += 2;
+                    m->dlMode = 0;
+                    if (ins & 0x40) m->dlWait = 1;
+                } else {
+                    if (ins & 0x40) {
+                        m->dlist = (m->dlist & 0xFC00) | ((m->dlist + 2) & 0x03FF);
+                        stolen += 2;
+                    }
+                    m->dlLinesLeft = modeLines[m->dlMode];
+                    m->dlFirstLine = 1;
+                }
+            }
+        }
+
+        /*Playfield: screen bytes on the first line, character data on every line*/
+        if (m->dlMode >= 2 && width) {
+            if (m->dlFirstLine) stolen += modeBytes[m->dlMode] * (width + 3) / 5;
+            if (m->dlMode <= 7) stolen += modeBytes[m->dlMode] * (width + 3) / 5;
+        }
+        m->dlFirstLine = 0;
+
+        /*Players and missiles*/
+        if (m->dmactl & 0x08) {
+            stolen += 5;
+        } else if (m->dmactl & 0x04) {
+            stolen += 1;
+        }
+
+        /*Display list interrupt on the last line of the mode line*/
+        if (--m->dlLinesLeft == 0 && m->dlDli) {
+            m->nmist = 0x80;
+            if (m->nmien & 0x80) m->nmiPending = 1;
+        }
+    }
+
+    if (m->line == A5200_VBI_LINE) {
+        m->nmist = 0x40;
+        if (m->nmien & 0x40) m->nmiPending = 1;
+    }
+
+    return stolen;
+}
+
+/*An NMI is taken, a DLI when NMIST says so*/
+static int nmi(A5200* m) {
+    int dli = (m->nmist & 0x80) != 0;
+
+    if (m->trace && m->trace->nmi) m->trace->nmi(m->traceCtx, m, dli);
+    if (dli) {
+        if (m->dliLine >= 0) m->dliNested++;
+        m->dliLine = m->line;
+        m->dliSp = m->sp;
+        m->dliSynced = 0;
+        m->dlis++;
+    }
+    return interrupt(m, 0xFFFA, 0);
+}
+
+/*Keypad and break key interrupts for the controls of the coming frame*/
+static void applyInput(A5200* m) {
+    if (m->input.key != A5200_KEY_NONE) {
+        if (m->input.key != m->lastInput.key) {
+            m->kbcode = (unsigned char) ((m->input.key & 0x0F) << 1);
+            if (m->irqen & 0x40) m->irqst &= ~0x40;
+        }
+        m->skstat &= ~0x04;
+    } else {
+        m->skstat |= 0x04;
+    }
+    if (m->input.trigger2 && !m->lastInput.trigger2 && (m->irqen & 0x80)) m->irqst &= ~0x80;
+    m->lastInput = m->input;
+}
+
+int a5200Init(A5200* m, const unsigned char* rom, unsigned long size) {
+    unsigned long i;
+    int p;
+
+    if (size != 4096 && size != 8192 && size != 16384 && size != 32768) return -1;
+
+    for (p = 0; p < 256; p++) {
+        if (p < 0x40) {
+            pageKind[p] = PAGE_RAM;
+        } else if (p < 0xC0 || p >= 0xF8) {
+            pageKind[p] = PAGE_ROM;
+        } else if (p < 0xD0) {
+            pageKind[p] = PAGE_GTIA;
+        } else if (p == 0xD4) {
+            pageKind[p] = PAGE_ANTIC;
+        } else if (p >= 0xE8 && p < 0xF0) {
+            pageKind[p] = PAGE_POKEY;
+        } else {
+            pageKind[p] = PAGE_NONE;
+        }
+    }
+
+    memset(m, 0, sizeof (*m));
+
+    /*Smaller images repeat through the cartridge space up to $BFFF*/
+    for (i = 0; i < 0x8000; i++) m->mem[0xBFFF - i] = rom[size - 1 - i % size];
+
+    memcpy(m->mem + BIOS_BASE, biosCode, sizeof (biosCode));
+    memcpy(m->mem + BIOS_EXIT, biosExit, sizeof (biosExit));
+    m->mem[0xFFFA] = BIOS_NMI & 0xFF;
+    m->mem[0xFFFB] = BIOS_NMI >> 8;
+    m->mem[0xFFFC] = m->mem[0xBFFE];
+    m->mem[0xFFFD] = m->mem[0xBFFF];
+    m->mem[0xFFFE] = BIOS_IRQ & 0xFF;
+    m->mem[0xFFFF] = BIOS_IRQ >> 8;
+
+    a5200Reset(m);
+    return 0;
+}
+
+static void setVector(A5200* m, unsigned short v, unsigned short target) {
+    m->mem[v] = target & 0xFF;
+    m->mem[v + 1] = target >> 8;
+}
+
+void a5200Reset(A5200* m) {
+    memset(m->mem, 0, 0x4000);
+
+    setVector(m, VIMIRQ, BIOS_IRQ_DISPATCH);
+    setVector(m, VVBLKI, BIOS_IMMEDIATE_VBI);
+    setVector(m, VVBLKD, BIOS_EXIT);
+    setVector(m, VDSLST, BIOS_DLI);
+    setVector(m, VKYBDI, BIOS_KEYBOARD);
+    setVector(m, VKYBDF, BIOS_EXIT);
+    setVector(m, VTRIGR, BIOS_BREAK);
+    setVector(m, VBRKOP, BIOS_IRQ_EXIT);
+
+    m->a = m->x = m->y = 0;
+    m->sp = 0xFF;
+    m->p = FLAG_U | FLAG_I;
+    m->pc = m->mem[0xFFFC] | (m->mem[0xFFFD] << 8);
+
+    m->cpuCycles = m->dmaCycles = m->wsyncCycles = 0;
+    m->frame = 0;
+    m->line = 0;
+    m->lineBudget = 0;
+
+    m->dmactl = m->chbase = m->pmbase = m->nmist = 0;
+    m->nmien = 0x40;
+    m->dlist = 0;
+    m->dlMode = m->dlLinesLeft = m->dlFirstLine = m->dlDli = m->dlWait = 0;
+    m->wsync = m->nmiPending = 0;
+    m->dliLine = -1;
+    m->dliSp = m->dliSynced = 0;
+    m->dlis = m->dliLate = m->dliNested = 0;
+
+    m->irqen = 0;
+    m->irqst = 0xFF;
+    m->kbcode = 0;
+    m->skstat = 0xFF;
+    m->random = 1;
+
+    m->input.potX = m->input.potY = A5200_POT_CENTER;
+    m->input.trigger = m->input.trigger2 = 0;
+    m->input.key = A5200_KEY_NONE;
+    m->lastInput = m->input;
+
+    m->illegal = 0;
+}
+
+void a5200Frame(A5200* m) {
+    int stolen, n;
+
+    applyInput(m);
+
+    for (m->line = 0; m->line < A5200_LINES_PER_FRAME; m->line++) {
+        stolen = startLine(m);
+        m->dmaCycles += stolen;
+        m->lineBudget += A5200_CYCLES_PER_LINE - stolen;
+
+        while (m->lineBudget > 0) {
+            if (m->nmiPending) {
+                m->nmiPending = 0;
+                n = nmi(m);
+            } else if (!(m->p & FLAG_I) && (~m->irqst & m->irqen & 0xC0)) {
+                n = interrupt(m, 0xFFFE, 0);
+            } else {
+                n = step(m);
+            }
+            m->cpuCycles += n;
+            m->lineBudget -= n;
+
+            /*WSYNC halts the CPU until the next line*/
+            if (m->wsync) {
+                m->wsync = 0;
+                if (m->lineBudget > 0) {
+                    m->cpuCycles += m->lineBudget;
+                    m->wsyncCycles += m->lineBudget;
+                    m->lineBudget = 0;
+                }
+            }
+        }
+    }
+    m->line = 0;
+    m->frame++;
+    if (m->trace && m->trace->frameEnd) m->trace->frameEnd(m->traceCtx, m);
+}
@@ -0,0 +1,137 @@
+/* Curse of the lost miner - headless Atari 5200 stand-in.
+ *
+ * Just enough of the console to run the cartridge image off the screen
+ * and count where the time goes:
+ *
+ * - NMOS 6502 with all documented opcodes, cycle exact per instruction
+ *   (page crossings, taken branches, decimal mode).
+ * - ANTIC display list processing that charges every scanline with the
+ *   cycles the real chip steals for memory refresh, display list,
+ *   playfield and player/missile DMA. The CPU gets 114 cycles per line
+ *   minus that, 262 lines per frame (NTSC). WSYNC halts the CPU until
+ *   the next line. DLIs fire at the start of the last line of a mode
+ *   line, the VBI at line 248. DLI handlers that reach WSYNC only on a
+ *   later line or are still running at the next DLI are counted.
+ * - GTIA triggers, POKEY pots, keypad and break key interrupts, all
+ *   other registers are write-only sinks.
+ * - A small BIOS written for the purpose: NMI and IRQ dispatch through
+ *   the usual RAM vectors, the immediate VBI with the shadow register
+ *   copies and the exit routine at $FCB2 the game jumps to. There is no
+ *   logo, no font and no keypad debouncing.
+ *
+ * Nothing is drawn and nothing is heard. A frame takes a few hundred
+ * microseconds on a PC, so runs go many times faster than real time.
+ */
+
+#ifndef A5200_H
+#define A5200_H
+
+#define A5200_CYCLES_PER_LINE (114)
+#define A5200_LINES_PER_FRAME (262)
+#define A5200_VBI_LINE (248)
+
+/*Pot readings*/
+#define A5200_POT_MIN (1)
+#define A5200_POT_CENTER (114)
+#define A5200_POT_MAX (228)
+
+#define A5200_KEY_NONE (0xFF)
+
+/*BIOS entry points, for naming them in traces*/
+#define A5200_BIOS_NMI (0xFC00)
+#define A5200_BIOS_IMMEDIATE_VBI (0xFC13)
+#define A5200_BIOS_IRQ (0xFC42)
+#define A5200_BIOS_IRQ_DISPATCH (0xFC45)
+#define A5200_BIOS_KEYBOARD (0xFC76)
+#define A5200_BIOS_EXIT (0xFCB2)
+
+/*Controller 1 as seen from the next frame on*/
+typedef struct {
+    unsigned char potX; /*Left to right*/
+    unsigned char potY; /*Up to down*/
+    unsigned char trigger; /*Top fire button, 1 pressed*/
+    unsigned char trigger2; /*Bottom fire button (break key), 1 pressed*/
+    unsigned char key; /*Keypad key 0-15 as the BIOS reports it, or A5200_KEY_NONE*/
+} A5200Input;
+
+struct A5200;
+
+/*Program flow observer. sp is the stack pointer before a call or
+ *interrupt pushes anything and after a return pulled everything
+ */
+typedef struct {
+    void (*call)(void* ctx, const struct A5200* m, unsigned short target, unsigned char sp);
+    void (*interrupt)(void* ctx, const struct A5200* m, unsigned short target, unsigned char sp);
+    void (*vectorJump)(void* ctx, const struct A5200* m, unsigned short vector, unsigned short target);
+    void (*ret)(void* ctx, const struct A5200* m, unsigned char sp);
+    void (*frameEnd)(void* ctx, const struct A5200* m);
+    void (*nmi)(void* ctx, const struct A5200* m, int dli); /*Before it is taken*/
+    void (*ioWrite)(void* ctx, const struct A5200* m, unsigned short addr, unsigned char v);
+} A5200Trace;
+
+typedef struct A5200 {
+
+    /*CPU*/
+    unsigned short pc;
+    unsigned char a, x, y, sp, p;
+
+    /*Address space, I/O pages are handled apart*/
+    unsigned char mem[65536];
+
+    /*Time. cpuCycles counts instructions, interrupt entries and WSYNC
+     *halts, dmaCycles what ANTIC took
+     */
+    unsigned long long cpuCycles;
+    unsigned long long dmaCycles;
+    unsigned long long wsyncCycles;
+    unsigned long frame;
+    int line;
+    int lineBudget;
+
+    /*ANTIC*/
+    unsigned char dmactl, chbase, pmbase, nmien, nmist;
+    unsigned short dlist;
+    unsigned char dlMode;
+    unsigned char dlLinesLeft;
+    unsigned char dlFirstLine;
+    unsigned char dlDli;
+    unsigned char dlWait;
+    unsigned char wsync;
+    unsigned char nmiPending;
+
+    /*DLI handlers. One is late when its first WSYNC comes on a line after
+     *the one the DLI fired on, so what it sets for the next row comes a
+     *line too low, nested when the next DLI fires before it returned
+     */
+    int dliLine; /*Line of the DLI whose handler runs, -1 for none*/
+    unsigned char dliSp; /*Stack pointer its RTI returns to*/
+    unsigned char dliSynced;
+    unsigned long dlis, dliLate, dliNested;
+
+    /*POKEY*/
+    unsigned char irqen, irqst, kbcode, skstat;
+    unsigned int random;
+
+    /*Controls*/
+    A5200Input input;
+    A5200Input lastInput;
+
+    /*Opcodes the stand-in does not know, executed as 2 cycle NOPs*/
+    unsigned long illegal;
+
+    const A5200Trace* trace;
+    void* traceCtx;
+} A5200;
+
+/*Put a cartridge image of 4, 8, 16 or 32KB in place and reset. Returns 0
+ *on success, -1 for an unsupported size
+ */
+int a5200Init(A5200* m, const unsigned char* rom, unsigned long size);
+
+/*Power on: clear RAM, set up the BIOS vectors and start the cartridge*/
+void a5200Reset(A5200* m);
+
+/*Run one video frame*/
+void a5200Frame(A5200* m);
+
+#endif
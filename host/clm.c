@@ -0,0 +1,168 @@
+/* Curse of the lost miner - headless game runner.
+ *
+ * Plays games on the host core with random joystick input, reports the
+ * outcome and how many frames per second the core manages. With -w every
+ * game is also recorded as a replay, prefix000000.clr, prefix000001.clr...
+ *
+ *   clm [-c cave] [-t] [-s] [-n frames] [-g games] [-r seed] [-w prefix] [-p]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "replay.h"
+
+static const char* const gameOverNames[] = {"none", "death", "success", "quit"};
+
+/*Random input held for a random number of frames*/
+typedef struct {
+    unsigned long long seed;
+    unsigned long until;
+    unsigned char current;
+} RandomInput;
+
+static unsigned long long nextRandom(RandomInput* r) {
+    r->seed ^= r->seed << 13;
+    r->seed ^= r->seed >> 7;
+    r->seed ^= r->seed << 17;
+    return r->seed;
+}
+
+static unsigned char randomInput(unsigned long frame, void* ctx) {
+    RandomInput* r = ctx;
+    unsigned long long n;
+
+    if (frame >= r->until) {
+        n = nextRandom(r);
+        r->current = n & (JS_LOG_DIRECTIONS | JS_LOG_FIRE);
+        r->until = frame + 1 + ((n >> 8) & 31);
+    }
+    return r->current;
+}
+
+/*Print the cave as the core sees it, miner as M*/
+static void printCave(void) {
+    static const char glyphs[] = " #<>[]~H^v***1234567800";
+    unsigned char x, y;
+
+    for (y = 0; y < CAVE_HEIGHT; y++) {
+        for (x = 0; x < CAVE_WIDTH; x++) {
+            if (x == clm.minerX && y == clm.minerY) {
+                putchar('M');
+            } else {
+                putchar(glyphs[clm.caveElements[CLM_CELL(x, y)]]);
+            }
+        }
+        putchar('\n');
+    }
+}
+
+static void usage(void) {
+    fprintf(stderr, "usage: clm [-c cave] [-t] [-s] [-n frames] [-g games] [-r seed] [-w prefix] [-p]\n"
+            "  -c cave    starting cave 1-%d\n"
+            "  -t         training cave\n"
+            "  -s         slow game speed\n"
+            "  -n frames  frame limit per game (default 100000)\n"
+            "  -g games   number of games (default 1)\n"
+            "  -r seed    random input seed\n"
+            "  -w prefix  record every game as a replay\n"
+            "  -p         print the cave when the last game is over\n", NUMBER_OF_CAVES);
+    exit(2);
+}
+
+int main(int argc, char** argv) {
+
+    unsigned char type = GAME_TYPE_NORMAL;
+    unsigned char cave = 0;
+    unsigned char speed = GAME_SPEED_NORMAL;
+    unsigned long maxFrames = 100000;
+    unsigned long games = 1;
+    unsigned long long seed = 1;
+    int print = 0;
+    int opt;
+    const char* prefix = NULL;
+    char path[4096];
+
+    unsigned long g;
+    unsigned long long totalFrames = 0;
+    struct timespec t0, t1;
+    double seconds;
+    RandomInput r;
+    ClmResult result;
+    ClmReplay replay;
+    ClmReplayRecorder recorder = {randomInput, &r, &replay};
+
+    while ((opt = getopt(argc, argv, "c:tsn:g:r:w:p")) != -1) {
+        switch (opt) {
+            case 'c':
+                cave = atoi(optarg) - 1;
+                if (cave > MAX_CAVE_INDEX) usage();
+                break;
+            case 't':
+                type = GAME_TYPE_TRAINING;
+                break;
+            case 's':
+                speed = GAME_SPEED_SLOW;
+                break;
+            case 'n':
+                maxFrames = strtoul(optarg, NULL, 0);
+                break;
+            case 'g':
+                games = strtoul(optarg, NULL, 0);
+                break;
+            case 'r':
+                seed = strtoull(optarg, NULL, 0);
+                break;
+            case 'w':
+                prefix = optarg;
+                break;
+            case 'p':
+                print = 1;
+                break;
+            default:
+                usage();
+        }
+    }
+
+    clmHostInit();
+
+    clock_gettime(CLOCK_MONOTONIC, &t0);
+    for (g = 0; g < games; g++) {
+        r.seed = seed + g * 0x9E3779B97F4A7C15ULL;
+        if (r.seed == 0) r.seed = 1;
+        r.until = 0;
+        if (prefix == NULL) {
+            clmHostPlay(type, cave, speed, randomInput, &r, maxFrames, &result);
+        } else {
+            clmReplayInit(&replay, type, cave, speed);
+            clmHostPlay(type, cave, speed, clmReplayRecordInput, &recorder, maxFrames, &result);
+            replay.length = result.frames;
+            replay.flags = CLM_REPLAY_HAS_RESULT;
+            replay.result = result;
+            replay.hash = clmHostHash();
+            snprintf(path, sizeof (path), "%s%06lu.clr", prefix, g);
+            if (clmReplaySave(&replay, path)) {
+                perror(path);
+                return 1;
+            }
+            clmReplayFree(&replay);
+        }
+        totalFrames += result.frames;
+        if (games == 1 || g + 1 == games) {
+            printf("game %lu: %s, cave %d, lives %d, %lu frames\n", g,
+                    gameOverNames[result.gameOverType], result.caveReached + 1,
+                    result.lives, result.frames);
+        }
+    }
+    clock_gettime(CLOCK_MONOTONIC, &t1);
+
+    seconds = (t1.tv_sec - t0.tv_sec) + (t1.tv_nsec - t0.tv_nsec) / 1e9;
+    printf("%llu frames in %.3f s, %.0f frames/s\n", totalFrames, seconds,
+            seconds > 0 ? totalFrames / seconds : 0.0);
+
+    if (print) printCave();
+
+    return 0;
+}
@@ -0,0 +1,167 @@
+/* Curse of the lost miner - frames of the animated tiles.
+ *
+ * The cave tiles are animated by the VBI switching ANTIC.chbase between
+ * frames of the cave font, so every diamond, spike and ladder on the
+ * screen changes at once and nothing is painted. Frame 0 is the font
+ * itself. This makes the other frames from it and writes ca65 source
+ * with only the glyphs that differ; the game copies the font to RAM and
+ * puts them over it when a cave starts:
+ *
+ *   _CLM_ANIM_CHARS    characters that animate, 0 ends the list
+ *   _CLM_ANIM_CHSET1   for frames 1..ANIM_FRAMES-1, 8 bytes for each of
+ *   _CLM_ANIM_CHSET2   the characters, of the first and second font
+ *
+ * A tile is two characters side by side, 8 multicolor pixels of 2 bits.
+ * A glint is a short diagonal band that sweeps across the tile and
+ * recolors its pixels; a roll scrolls the tile down a row per frame.
+ *
+ *   clmanim clmfont1.fnt clmfont2.fnt fontanim.s
+ */
+
+#include <stdio.h>
+#include <string.h>
+
+#define FONT_SIZE (1024)
+
+/*Frames, the font included. main.c and the VBI count on 4*/
+#define ANIM_FRAMES (4)
+
+#define FX_GLINT (0)
+#define FX_ROLL (1)
+
+/*Any colour but the background*/
+#define ANY (0)
+
+typedef struct {
+    unsigned char ch; /*Left character, the right one follows*/
+    unsigned char fx;
+    unsigned char from; /*Glint - pixels of this colour change, ANY for all*/
+    unsigned char to; /*Glint - to this colour*/
+} Tile;
+
+/*Character pairs as in elem2CharMap of clmcore.c*/
+static const Tile tiles[] = {
+    {84, FX_GLINT, ANY, 2}, /*DIAM 1*/
+    {86, FX_GLINT, ANY, 2}, /*DIAM 2*/
+    {88, FX_GLINT, ANY, 2}, /*DIAM 3*/
+    {66, FX_GLINT, 2, 3}, /*DEATH BOTTOM TOP*/
+    {76, FX_GLINT, 2, 3}, /*DEATH TOP BOTTOM*/
+    {78, FX_ROLL, 0, 0} /*LADDER*/
+};
+
+#define TILE_COUNT (sizeof (tiles) / sizeof (tiles[0]))
+
+static unsigned char fonts[2][FONT_SIZE];
+
+static unsigned char pixel(const unsigned char* glyphs, int x, int y) {
+    return (glyphs[(x >> 2) * 8 + y] >> (6 - ((x & 3) << 1))) & 3;
+}
+
+static void setPixel(unsigned char* glyphs, int x, int y, unsigned char c) {
+    int shift = 6 - ((x & 3) << 1);
+    unsigned char* b = &glyphs[(x >> 2) * 8 + y];
+
+    *b = (*b & ~(3 << shift)) | (c << shift);
+}
+
+/*Two characters of a tile in a frame, 16 bytes*/
+static void makeFrame(const unsigned char* font, const Tile* t, int frame, unsigned char* out) {
+    const unsigned char* in = font + t->ch * 8;
+    int x, y, band;
+
+    switch (t->fx) {
+        case FX_GLINT:
+            for (x = 0; x < 16; x++) out[x] = in[x];
+            band = 2 + (frame - 1) * 4;
+            for (y = 0; y < 8; y++) {
+                for (x = 0; x < 8; x++) {
+                    unsigned char c = pixel(in, x, y);
+
+                    if (x + y < band || x + y > band + 1 || c == 0) continue;
+                    if (t->from == ANY || c == t->from) setPixel(out, x, y, t->to);
+                }
+            }
+            break;
+        case FX_ROLL:
+            for (y = 0; y < 8; y++) {
+                out[(y + frame) & 7] = in[y];
+                out[8 + ((y + frame) & 7)] = in[8 + y];
+            }
+            break;
+    }
+}
+
+static const char* baseName(const char* name) {
+    const char* s = strrchr(name, '/');
+
+    return s ? s + 1 : name;
+}
+
+static int readFont(const char* name, unsigned char* font) {
+    FILE* f = fopen(name, "rb");
+
+    if (!f) {
+        perror(name);
+        return -1;
+    }
+    if (fread(font, 1, FONT_SIZE, f) != FONT_SIZE) {
+        fprintf(stderr, "clmanim: %s is not a %d byte font\n", name, FONT_SIZE);
+        fclose(f);
+        return -1;
+    }
+    fclose(f);
+    return 0;
+}
+
+int main(int argc, char** argv) {
+
+    unsigned char glyphs[16];
+    unsigned int i, j, n;
+    int font, frame;
+    FILE* f;
+
+    if (argc != 4) {
+        fprintf(stderr, "usage: clmanim font1.fnt font2.fnt fontanim.s\n");
+        return 2;
+    }
+    if (readFont(argv[1], fonts[0]) || readFont(argv[2], fonts[1])) return 1;
+
+    f = fopen(argv[3], "w");
+    if (!f) {
+        perror(argv[3]);
+        return 1;
+    }
+    fprintf(f, ";Curse of the lost miner - animated tiles, made by clmanim from\n"
+            ";%s and %s. Frames 1-%d, frame 0 is the font\n\n", baseName(argv[1]), baseName(argv[2]),
+            ANIM_FRAMES - 1);
+
+    fprintf(f, "_CLM_ANIM_CHARS:\n.byte ");
+    for (i = 0; i < TILE_COUNT; i++) {
+        fprintf(f, "%u,%u,", tiles[i].ch, tiles[i].ch + 1);
+    }
+    fprintf(f, "0\n");
+
+    n = 0;
+    for (font = 0; font < 2; font++) {
+        fprintf(f, "\n_CLM_ANIM_CHSET%d:\n", font + 1);
+        for (frame = 1; frame < ANIM_FRAMES; frame++) {
+            fprintf(f, ";Frame %d\n", frame);
+            for (i = 0; i < TILE_COUNT; i++) {
+                makeFrame(fonts[font], &tiles[i], frame, glyphs);
+                for (j = 0; j < 16; j += 8) {
+                    fprintf(f, ".byte $%02X,$%02X,$%02X,$%02X,$%02X,$%02X,$%02X,$%02X\n",
+                            glyphs[j], glyphs[j + 1], glyphs[j + 2], glyphs[j + 3],
+                            glyphs[j + 4], glyphs[j + 5], glyphs[j + 6], glyphs[j + 7]);
+                    n += 8;
+                }
+            }
+        }
+    }
+
+    if (fclose(f)) {
+        perror(argv[3]);
+        return 1;
+    }
+    printf("%u tiles, %d frames, %u bytes of glyphs, %s\n", (unsigned int) TILE_COUNT, ANIM_FRAMES, n, argv[3]);
+    return 0;
+}
@@ -0,0 +1,557 @@
+/* Curse of the lost miner - microbenchmarks of the game core.
+ *
+ * Runs the cave, physics and paint routines of clmcore.c in tight loops
+ * over every cave, the training cave included, and reports per call the
+ * nanoseconds (best of the runs), the instructions and the heap
+ * allocations the core made. These are the host side of the numbers
+ * clmprof gives for the 6502.
+ *
+ * Time is also given in units of a calibration loop, a chain of dependent
+ * byte loads and stores that does not touch the core: a unit is the time
+ * of one of its bytes. Each run of a bench is cut in slices, each timed
+ * right after a short run of the loop, and the median of the slices
+ * counts, so the units follow the speed of the machine and of the moment
+ * better than nanoseconds do.
+ *
+ * Instructions are counted exactly: a child process is stepped through
+ * a short run of each bench one instruction at a time (ptrace), so the
+ * count only depends on the code built, not on the machine being busy.
+ * A shared machine still moves the time by tens of percent, units or not.
+ *
+ * With -b the results are checked against a baseline and the exit status
+ * is 1 when any of them got worse than allowed: instructions by more than
+ * 1 percent, allocations at all. Time is compared for information only.
+ * The baseline in the tree, clmbench.base, was taken with the compiler it
+ * names; instructions are not compared against a baseline of another
+ * compiler. -w writes the results as a new baseline.
+ *
+ *   clmbench [-n runs] [-b baseline] [-w baseline] [bench...]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#ifdef __linux__
+#include <signal.h>
+#include <sys/ptrace.h>
+#include <sys/wait.h>
+#endif
+
+#include "clmhost.h"
+
+#define CAVES (TRAINING_CAVE_INDEX + 1)
+#define CAVE_SCREEN (CAVE_HEIGHT * 40)
+
+/*Frames the physics bench steps through each cave in a run*/
+#define STEP_FRAMES (1024)
+
+/*Instructions may grow this much before it counts as a regression*/
+#define INSN_TOLERANCE (1.0)
+
+#define NO_INSN (-1.0)
+
+typedef struct {
+    const char* name;
+    unsigned long (*run)(unsigned long reps); /*Returns the calls made*/
+    unsigned long reps;
+    unsigned long countReps; /*Reps of the run the instructions are counted in*/
+} Bench;
+
+typedef struct {
+    double ns;
+    double units; /*ns in calibration bytes*/
+    double insn;
+    double allocs;
+} Result;
+
+/*Heap allocations, counted by the --wrap of malloc and friends*/
+static unsigned long allocations;
+
+void* __real_malloc(size_t n);
+void* __real_calloc(size_t n, size_t size);
+void* __real_realloc(void* p, size_t n);
+
+void* __wrap_malloc(size_t n) {
+    allocations++;
+    return __real_malloc(n);
+}
+
+void* __wrap_calloc(size_t n, size_t size) {
+    allocations++;
+    return __real_calloc(n, size);
+}
+
+void* __wrap_realloc(void* p, size_t n) {
+    allocations++;
+    return __real_realloc(p, n);
+}
+
+/*Calibration loop, CAL_BYTES dependent loads and stores a call*/
+#define CAL_BYTES (1024)
+#define CAL_REPS (200)
+
+/*Slices of a run timed against the calibration loop*/
+#define UNIT_SLICES (10)
+
+/*Most runs of a bench*/
+#define MAX_RUNS (99)
+
+static unsigned char calTable[256];
+unsigned char calOut[CAL_BYTES]; /*Not static, so the stores are kept*/
+
+static void makeCalTable(void) {
+    unsigned int i;
+
+    for (i = 0; i < 256; i++) calTable[i] = (unsigned char) (i * 167 + 13);
+}
+
+static unsigned long benchCalibrate(unsigned long reps) {
+    unsigned long r;
+    unsigned int i;
+    unsigned char v = 1;
+
+    for (r = 0; r < reps; r++) {
+        for (i = 0; i < CAL_BYTES; i++) {
+            v = calTable[(unsigned char) (v + i)] ^ (unsigned char) r;
+            calOut[i] = v;
+        }
+    }
+    return reps;
+}
+
+/*Each cave once, rebuilt from levels.pak and painted*/
+static unsigned long benchRebuild(unsigned long reps) {
+    unsigned long r;
+    unsigned char cv;
+
+    for (r = 0; r < reps; r++) {
+        for (cv = 0; cv < CAVES; cv++) rebuildCaveElementArray(cv);
+    }
+    return reps * CAVES;
+}
+
+/*Each cave entered once it was decoded ahead, what is left of the
+ *rebuild when a cave comes after another
+ */
+static unsigned long benchEnterCave(unsigned long reps) {
+    unsigned long r;
+    unsigned char cv;
+
+    for (cv = 0; cv < CAVES; cv++) {
+        clmPrepareCave(cv, clmScreen);
+        while (clmPrepareStep(255) != 0) {
+        }
+        for (r = 0; r < reps; r++) clmEnterCave();
+    }
+    return reps * CAVES;
+}
+
+static unsigned long benchPaintCave(unsigned long reps) {
+    unsigned long r;
+    unsigned char cv;
+
+    for (cv = 0; cv < CAVES; cv++) {
+        rebuildCaveElementArray(cv);
+        for (r = 0; r < reps; r++) paintCave();
+    }
+    return reps * CAVES;
+}
+
+/*Every cell of every cave*/
+static unsigned long benchPaintElement(unsigned long reps) {
+    unsigned long r;
+    unsigned char cv, x, y;
+
+    for (cv = 0; cv < CAVES; cv++) {
+        rebuildCaveElementArray(cv);
+        for (r = 0; r < reps; r++) {
+            for (y = 0; y < CAVE_HEIGHT; y++) {
+                for (x = 0; x < CAVE_WIDTH; x++) {
+                    paintElement(x, y, clm.caveElements[CLM_CELL(x, y)]);
+                }
+            }
+        }
+    }
+    return reps * CAVES * CAVE_CELLS;
+}
+
+/*Random input held for a random number of frames, as clm plays*/
+static unsigned char stepInput[STEP_FRAMES];
+
+static void makeStepInput(void) {
+    unsigned long long seed = 42;
+    unsigned char current = 0;
+    unsigned long f, until = 0;
+
+    for (f = 0; f < STEP_FRAMES; f++) {
+        if (f >= until) {
+            seed ^= seed << 13;
+            seed ^= seed >> 7;
+            seed ^= seed << 17;
+            current = seed & (JS_LOG_DIRECTIONS | JS_LOG_FIRE);
+            until = f + 1 + ((seed >> 8) & 31);
+        }
+        stepInput[f] = current;
+    }
+}
+
+/*One frame of physics. A cave that ends goes back to its start, which
+ *is a copy of the state and the screen and is timed with the steps
+ */
+static unsigned long benchStep(unsigned long reps) {
+    static ClmState start;
+    static unsigned char startScreen[CAVE_SCREEN];
+    unsigned long r, f;
+    unsigned char cv;
+
+    for (cv = 0; cv < CAVES; cv++) {
+        memset(&clm, 0, sizeof (clm));
+        clmNewGame(cv == TRAINING_CAVE_INDEX ? GAME_TYPE_TRAINING : GAME_TYPE_NORMAL, cv, GAME_SPEED_NORMAL);
+        clmStartCave();
+        start = clm;
+        memcpy(startScreen, clmScreen, CAVE_SCREEN);
+
+        for (r = 0; r < reps; r++) {
+            for (f = 0; f < STEP_FRAMES; f++) {
+                if (clmStep(stepInput[f]) == 0) {
+                    clm = start;
+                    memcpy(clmScreen, startScreen, CAVE_SCREEN);
+                }
+            }
+        }
+    }
+    return reps * CAVES * STEP_FRAMES;
+}
+
+/*Lives and caves reached as they come in a game*/
+static unsigned long benchStatusBar(unsigned long reps) {
+    unsigned long r;
+    unsigned char cv;
+
+    for (r = 0; r < reps; r++) {
+        for (cv = 0; cv < CAVES; cv++) {
+            clm.gameType = cv == TRAINING_CAVE_INDEX ? GAME_TYPE_TRAINING : GAME_TYPE_NORMAL;
+            clm.currentCave = cv;
+            clm.lives = 4 - (cv & 3);
+            updateStatusBar();
+        }
+    }
+    return reps * CAVES;
+}
+
+static const Bench benches[] = {
+    {"rebuild", benchRebuild, 2000, 1},
+    {"enterCave", benchEnterCave, 20000, 10},
+    {"paintCave", benchPaintCave, 5000, 1},
+    {"paintElement", benchPaintElement, 5000, 1},
+    {"step", benchStep, 400, 1},
+    {"statusBar", benchStatusBar, 100000, 100}
+};
+
+#define BENCH_COUNT (sizeof (benches) / sizeof (benches[0]))
+
+static double nanoseconds(const struct timespec* t0, const struct timespec* t1) {
+    return (t1->tv_sec - t0->tv_sec) * 1e9 + (t1->tv_nsec - t0->tv_nsec);
+}
+
+static int compareDouble(const void* a, const void* b) {
+    double x = *(const double*) a, y = *(const double*) b;
+    return (x > y) - (x < y);
+}
+
+/*Best of the runs, per call*/
+static void runBench(const Bench* b, int runs, Result* result) {
+    struct timespec t0, t1;
+    unsigned long calls, before;
+    double ns;
+    int i;
+
+    result->ns = 0;
+    result->allocs = 0;
+
+    /*Warm up the caches and the branch predictors*/
+    b->run(b->reps / 10 + 1);
+
+    for (i = 0; i < runs; i++) {
+        before = allocations;
+        clock_gettime(CLOCK_MONOTONIC, &t0);
+        calls = b->run(b->reps);
+        clock_gettime(CLOCK_MONOTONIC, &t1);
+
+        ns = nanoseconds(&t0, &t1) / calls;
+        if (i == 0 || ns < result->ns) result->ns = ns;
+        if ((double) (allocations - before) / calls > result->allocs) {
+            result->allocs = (double) (allocations - before) / calls;
+        }
+    }
+}
+
+/*Time in calibration units - the median of slices of the bench, each
+ *timed right after a slice of the calibration loop
+ */
+static void runUnits(const Bench* b, int runs, Result* result) {
+    static double units[MAX_RUNS * UNIT_SLICES];
+    struct timespec t0, t1;
+    unsigned long calls;
+    double unit;
+    int i;
+
+    for (i = 0; i < runs * UNIT_SLICES; i++) {
+        clock_gettime(CLOCK_MONOTONIC, &t0);
+        benchCalibrate(CAL_REPS);
+        clock_gettime(CLOCK_MONOTONIC, &t1);
+        unit = nanoseconds(&t0, &t1) / CAL_REPS / CAL_BYTES;
+
+        clock_gettime(CLOCK_MONOTONIC, &t0);
+        calls = b->run(b->reps / UNIT_SLICES);
+        clock_gettime(CLOCK_MONOTONIC, &t1);
+        units[i] = nanoseconds(&t0, &t1) / calls / unit;
+    }
+
+    qsort(units, runs * UNIT_SLICES, sizeof (units[0]), compareDouble);
+    result->units = units[runs * UNIT_SLICES / 2];
+}
+
+/*Instructions per call, NO_INSN when the child cannot be traced. The
+ *bench has run before, so no symbol is still to be bound in the child
+ */
+static double countInsn(const Bench* b) {
+#ifdef __linux__
+    pid_t child;
+    int status;
+    double n = 0;
+
+    fflush(stdout);
+    child = fork();
+    if (child < 0) return NO_INSN;
+    if (child == 0) {
+        if (ptrace(PTRACE_TRACEME, 0, NULL, NULL) < 0) _exit(1);
+        raise(SIGSTOP);
+        b->run(b->countReps);
+        raise(SIGSTOP);
+        _exit(0);
+    }
+
+    /*Every step stops with SIGTRAP until the child stops itself again*/
+    if (waitpid(child, &status, 0) < 0 || !WIFSTOPPED(status)) return NO_INSN;
+    while (1) {
+        if (ptrace(PTRACE_SINGLESTEP, child, NULL, NULL) < 0) break;
+        if (waitpid(child, &status, 0) < 0 || !WIFSTOPPED(status)) break;
+        if (WSTOPSIG(status) != SIGTRAP) break;
+        n++;
+    }
+    kill(child, SIGKILL);
+    waitpid(child, &status, 0);
+    if (!WIFSIGNALED(status)) return NO_INSN;
+
+    /*The same run here gives the calls*/
+    return n / b->run(b->countReps);
+#else
+    (void) b;
+    return NO_INSN;
+#endif
+}
+
+/*Compiler of this build, instructions only compare within one*/
+#if defined(__GNUC__) && !defined(__clang__)
+#define COMPILER "gcc " __VERSION__
+#elif defined(__VERSION__)
+#define COMPILER __VERSION__
+#else
+#define COMPILER "unknown"
+#endif
+
+/*Compiler a baseline was taken with, "" when it does not say*/
+static void baseCompiler(FILE* f, char* compiler, size_t size) {
+    char line[256];
+    size_t n;
+
+    compiler[0] = 0;
+    rewind(f);
+    while (fgets(line, sizeof (line), f)) {
+        if (strncmp(line, "# compiler ", 11)) continue;
+        n = strcspn(line + 11, "\n");
+        if (n >= size) n = size - 1;
+        memcpy(compiler, line + 11, n);
+        compiler[n] = 0;
+        return;
+    }
+}
+
+/*Baseline file - a line per bench: name units/op instructions/op
+ *allocations/op, "-" for instructions not counted
+ */
+static int findBase(FILE* f, const char* name, Result* base) {
+    char line[256], n[64], insn[64];
+
+    rewind(f);
+    while (fgets(line, sizeof (line), f)) {
+        if (line[0] == '#') continue;
+        if (sscanf(line, "%63s %lf %63s %lf", n, &base->units, insn, &base->allocs) != 4) continue;
+        if (strcmp(n, name)) continue;
+        base->insn = strcmp(insn, "-") ? atof(insn) : NO_INSN;
+        return 1;
+    }
+    return 0;
+}
+
+static void printMetric(double v, const char* format) {
+    if (v == NO_INSN) {
+        printf(" %10s", "-");
+    } else {
+        printf(format, v);
+    }
+}
+
+/*Compare with the baseline, print the changes, return 1 for a
+ *regression. Time is only shown
+ */
+static int compare(const Result* r, const Result* base, int sameCompiler) {
+    double di;
+    int worse = 0;
+
+    printf("  %+6.1f%%", (r->units - base->units) * 100.0 / base->units);
+    if (r->insn != NO_INSN && base->insn != NO_INSN && sameCompiler) {
+        di = (r->insn - base->insn) * 100.0 / base->insn;
+        printf(" %+6.2f%%", di);
+        if (di > INSN_TOLERANCE) {
+            printf(" instructions");
+            worse = 1;
+        }
+    } else {
+        printf(" %7s", "-");
+    }
+    if (r->allocs > base->allocs) {
+        printf(" allocations");
+        worse = 1;
+    }
+    printf(worse ? " REGRESSION" : " ok");
+    return worse;
+}
+
+static void usage(void) {
+    unsigned int i;
+
+    fprintf(stderr, "usage: clmbench [-n runs] [-b baseline] [-w baseline] [bench...]\n"
+            "  -n runs     timed runs of each bench (default 9)\n"
+            "  -b file     compare with a baseline, exit 1 on a regression\n"
+            "  -w file     write the results as a baseline\n"
+            "benches:");
+    for (i = 0; i < BENCH_COUNT; i++) fprintf(stderr, " %s", benches[i].name);
+    fputc('\n', stderr);
+    exit(2);
+}
+
+int main(int argc, char** argv) {
+
+    int runs = 9;
+    const char* basePath = NULL;
+    const char* outPath = NULL;
+    int opt;
+
+    FILE* baseFile = NULL;
+    FILE* out = NULL;
+    unsigned int i;
+    int a, selected, sameCompiler = 0, missing = 0, regressions = 0;
+    char compiler[200];
+    Result r, base;
+
+    while ((opt = getopt(argc, argv, "n:b:w:")) != -1) {
+        switch (opt) {
+            case 'n':
+                runs = atoi(optarg);
+                if (runs < 1 || runs > MAX_RUNS) usage();
+                break;
+            case 'b':
+                basePath = optarg;
+                break;
+            case 'w':
+                outPath = optarg;
+                break;
+            default:
+                usage();
+        }
+    }
+    for (a = optind; a < argc; a++) {
+        for (i = 0; i < BENCH_COUNT && strcmp(argv[a], benches[i].name); i++);
+        if (i == BENCH_COUNT) usage();
+    }
+
+    if (basePath) {
+        baseFile = fopen(basePath, "r");
+        if (!baseFile) {
+            perror(basePath);
+            return 2;
+        }
+        baseCompiler(baseFile, compiler, sizeof (compiler));
+        sameCompiler = !strcmp(compiler, COMPILER);
+        if (!sameCompiler) {
+            printf("Baseline taken with %s, not %s: instructions are not compared\n",
+                    compiler[0] ? compiler : "an unknown compiler", COMPILER);
+        }
+    }
+    if (outPath) {
+        out = fopen(outPath, "w");
+        if (!out) {
+            perror(outPath);
+            return 2;
+        }
+        fprintf(out, "# clmbench baseline: bench units/op instructions/op allocations/op\n"
+                "# compiler %s\n", COMPILER);
+    }
+
+    clmHostInit();
+    makeStepInput();
+    makeCalTable();
+
+    printf("%-14s %10s %10s %10s %10s%s\n", "bench", "ns/op", "units/op", "insn/op", "allocs/op",
+            baseFile ? "  baseline: time insn" : "");
+    for (i = 0; i < BENCH_COUNT; i++) {
+        selected = optind == argc;
+        for (a = optind; a < argc; a++) {
+            if (!strcmp(argv[a], benches[i].name)) selected = 1;
+        }
+        if (!selected) continue;
+
+        runBench(&benches[i], runs, &r);
+        runUnits(&benches[i], runs, &r);
+        r.insn = countInsn(&benches[i]);
+        printf("%-14s %10.1f %10.2f", benches[i].name, r.ns, r.units);
+        printMetric(r.insn, " %10.1f");
+        printf(" %10.2f", r.allocs);
+        if (baseFile) {
+            if (findBase(baseFile, benches[i].name, &base)) {
+                regressions += compare(&r, &base, sameCompiler);
+            } else {
+                printf("  not in the baseline");
+                missing++;
+            }
+        }
+        putchar('\n');
+
+        if (out) {
+            fprintf(out, "%s %.2f ", benches[i].name, r.units);
+            if (r.insn == NO_INSN) {
+                fprintf(out, "-");
+            } else {
+                fprintf(out, "%.1f", r.insn);
+            }
+            fprintf(out, " %.2f\n", r.allocs);
+        }
+    }
+
+    if (baseFile) fclose(baseFile);
+    if (out && fclose(out)) {
+        perror(outPath);
+        return 2;
+    }
+    if (regressions) {
+        printf("%d regression%s against %s\n", regressions, regressions == 1 ? "" : "s", basePath);
+        return 1;
+    }
+    if (missing) printf("%d bench%s not in %s\n", missing, missing == 1 ? "" : "es", basePath);
+    return 0;
+}
@@ -0,0 +1,86 @@
+/* Curse of the lost miner - host platform for the game core.
+ * See clmhost.h.
+ */
+
+#include <stddef.h>
+#include <string.h>
+
+#include "clmhost.h"
+
+/*Cave display memory of this thread and the status bar below*/
+static CLM_TLS unsigned char hostScreen[(CAVE_HEIGHT + 1) * 40];
+
+/*Sound effects are not played on the host*/
+void rmtPlayDiamond(void) {
+}
+
+void rmtPlayPicked(void) {
+}
+
+void rmtPlayJump(void) {
+}
+
+void clmHostInit() {
+    clmScreen = hostScreen;
+}
+
+unsigned char* clmHostScreen() {
+    return hostScreen;
+}
+
+static unsigned long long fnv1a(unsigned long long h, const unsigned char* p, unsigned long n) {
+    while (n--) {
+        h ^= *p++;
+        h *= 0x100000001B3ULL;
+    }
+    return h;
+}
+
+unsigned long long clmHostHash() {
+    unsigned long long h = 0xCBF29CE484222325ULL;
+
+    h = fnv1a(h, (const unsigned char*) &clm, offsetof(ClmState, brokenCell));
+
+    /*Only the rocks the cave has, the table is not cleared past them*/
+    h = fnv1a(h, (const unsigned char*) clm.brokenCell, clm.brokenCount * sizeof (clm.brokenCell[0]));
+    h = fnv1a(h, clm.brokenTicks, clm.brokenCount);
+
+    /*The undo log only tells how to get back to the start of the cave*/
+    h = fnv1a(h, &clm.diamondsInCave, offsetof(ClmState, undoCount) - offsetof(ClmState, diamondsInCave));
+    return fnv1a(h, hostScreen, CAVE_HEIGHT * 40);
+}
+
+void clmHostPlay(unsigned char type, unsigned char startCave, unsigned char speed,
+        ClmInputFunc input, void* ctx, unsigned long maxFrames, ClmResult* result) {
+
+    unsigned long frame = 0;
+
+    /*Nothing left over from the game before, so the hash only depends on
+     *the input
+     */
+    memset(&clm, 0, sizeof (clm));
+    clmNewGame(type, startCave, speed);
+
+    /*Cave loop*/
+    do {
+        if (clm.caveDeath) {
+            clmRestartCave();
+        } else {
+            clmStartCave();
+        }
+
+        /*Controls and physics loop - one core step per frame*/
+        while (frame < maxFrames && clmStep(input(frame, ctx))) {
+            frame++;
+        }
+
+        if (clm.stayHere) break;
+        frame++;
+
+    } while (clmEndCave() == GAME_OVER_NONE);
+
+    result->gameOverType = clm.gameOverType;
+    result->caveReached = clm.currentCave;
+    result->lives = clm.lives;
+    result->frames = frame;
+}
@@ -0,0 +1,37 @@
+/* Curse of the lost miner - host platform for the game core.
+ *
+ * Gives every thread its own cave screen, stubs the sound effects and
+ * offers a frame loop that plays a whole game the way doGame does on
+ * the cartridge, minus the presentation (death skull, screens, delays).
+ */
+
+#ifndef CLMHOST_H
+#define CLMHOST_H
+
+#include "clmcore.h"
+
+/*Logical input for a given frame*/
+typedef unsigned char (*ClmInputFunc)(unsigned long frame, void* ctx);
+
+/*Outcome of a game played on the host*/
+typedef struct {
+    unsigned char gameOverType; /*GAME_OVER_NONE if the frame limit hit*/
+    unsigned char caveReached;
+    unsigned char lives;
+    unsigned long frames;
+} ClmResult;
+
+/*Per-thread set-up, call before any other core function*/
+void clmHostInit(void);
+
+/*Play a game from clmNewGame to game over or maxFrames*/
+void clmHostPlay(unsigned char type, unsigned char startCave, unsigned char speed,
+        ClmInputFunc input, void* ctx, unsigned long maxFrames, ClmResult* result);
+
+/*Cave screen of this thread, 22 rows of 40 characters and the status bar*/
+unsigned char* clmHostScreen(void);
+
+/*64-bit FNV-1a hash of the core state and the cave screen of this thread*/
+unsigned long long clmHostHash(void);
+
+#endif
@@ -0,0 +1,231 @@
+/* Curse of the lost miner - cave packer.
+ *
+ * Turns levels.dat (CAVESIZE bytes per cave: start row, start column and
+ * 440 element nibbles) into the packed levels.pak the game reads:
+ *
+ *   byte 0            number of caves n
+ *   bytes 1..2n+2     offsets of the caves and of the end, little endian
+ *   each cave         start row, start column, nibble stream
+ *
+ * The nibble stream, high nibble first, fills the cave row after row:
+ *
+ *   0-9, 14, 15  the element itself
+ *   10           the element before twice more
+ *   11           the element before three times more
+ *   12 n         n + 2 elements copied from the row above
+ *   13 n         the element before n + 4 times more
+ *
+ * Diamonds are always written out, each one is counted and gets its
+ * type when it is decoded. The parse is optimal for this code set. A
+ * cave may have at most CLM_BROKEN_SIZE broken rocks.
+ *
+ *   clmpack [-v] levels.dat levels.pak
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "clmcore.h"
+
+#define MAX_CAVES (64)
+
+#define COPY_MIN (PACK_COPY_MIN)
+#define COPY_MAX (PACK_COPY_MIN + 15)
+#define RUN_MIN (PACK_RUN_MIN)
+#define RUN_MAX (PACK_RUN_MIN + 15)
+
+typedef struct {
+    unsigned char nibbles[2 * CAVE_CELLS];
+    int count;
+} Stream;
+
+static void put(Stream* s, unsigned char n) {
+    s->nibbles[s->count++] = n;
+}
+
+/*Can cells i..i+length-1 repeat the cell before or copy the row above*/
+static int repeats(const unsigned char* cells, int i, int length) {
+    int k;
+
+    if (i == 0) return 0;
+    for (k = 0; k < length; k++) {
+        if (i + k >= CAVE_CELLS || cells[i + k] != cells[i - 1] || cells[i + k] == EXT_E_DIAM) return 0;
+    }
+    return 1;
+}
+
+static int copies(const unsigned char* cells, int i, int length) {
+    int k;
+
+    if (i < CAVE_WIDTH) return 0;
+    for (k = 0; k < length; k++) {
+        if (i + k >= CAVE_CELLS || cells[i + k] != cells[i + k - CAVE_WIDTH] || cells[i + k] == EXT_E_DIAM) return 0;
+    }
+    return 1;
+}
+
+/*Shortest stream by dynamic programming over the cells, from the end*/
+static void pack(const unsigned char* cells, Stream* s) {
+    int cost[CAVE_CELLS + 1];
+    int take[CAVE_CELLS];
+    unsigned char code[CAVE_CELLS];
+    int i, n;
+
+    cost[CAVE_CELLS] = 0;
+    for (i = CAVE_CELLS - 1; i >= 0; i--) {
+        cost[i] = 1 + cost[i + 1];
+        take[i] = 1;
+        code[i] = cells[i];
+
+        if (repeats(cells, i, 2) && 1 + cost[i + 2] < cost[i]) {
+            cost[i] = 1 + cost[i + 2];
+            take[i] = 2;
+            code[i] = PACK_REPEAT_2;
+        }
+        if (repeats(cells, i, 3) && 1 + cost[i + 3] < cost[i]) {
+            cost[i] = 1 + cost[i + 3];
+            take[i] = 3;
+            code[i] = PACK_REPEAT_3;
+        }
+        for (n = RUN_MIN; n <= RUN_MAX && repeats(cells, i, n); n++) {
+            if (2 + cost[i + n] < cost[i]) {
+                cost[i] = 2 + cost[i + n];
+                take[i] = n;
+                code[i] = PACK_RUN;
+            }
+        }
+        for (n = COPY_MIN; n <= COPY_MAX && copies(cells, i, n); n++) {
+            if (2 + cost[i + n] < cost[i]) {
+                cost[i] = 2 + cost[i + n];
+                take[i] = n;
+                code[i] = PACK_COPY;
+            }
+        }
+    }
+
+    s->count = 0;
+    for (i = 0; i < CAVE_CELLS; i += take[i]) {
+        put(s, code[i]);
+        if (code[i] == PACK_RUN) put(s, take[i] - RUN_MIN);
+        if (code[i] == PACK_COPY) put(s, take[i] - COPY_MIN);
+    }
+}
+
+/*Decode a stream back to external elements, returns the nibbles used*/
+static int unpack(const unsigned char* bytes, unsigned char* cells) {
+    int i = 0, at = 0, n, k;
+    unsigned char c;
+
+#define NIBBLE() ((at & 1) ? bytes[at++ >> 1] & 0x0F : bytes[at++ >> 1] >> 4)
+
+    while (i < CAVE_CELLS) {
+        c = NIBBLE();
+        switch (c) {
+            case PACK_REPEAT_2:
+            case PACK_REPEAT_3:
+                for (k = 0; k < c - PACK_REPEAT_2 + 2 && i < CAVE_CELLS; k++, i++) cells[i] = cells[i - 1];
+                break;
+            case PACK_RUN:
+                n = NIBBLE() + RUN_MIN;
+                for (k = 0; k < n && i < CAVE_CELLS; k++, i++) cells[i] = cells[i - 1];
+                break;
+            case PACK_COPY:
+                n = NIBBLE() + COPY_MIN;
+                for (k = 0; k < n && i < CAVE_CELLS; k++, i++) cells[i] = cells[i - CAVE_WIDTH];
+                break;
+            default:
+                cells[i++] = c;
+        }
+    }
+    return at;
+#undef NIBBLE
+}
+
+static void usage(void) {
+    fprintf(stderr, "usage: clmpack [-v] levels.dat levels.pak\n"
+            "  -v  print the size of every cave\n");
+    exit(2);
+}
+
+int main(int argc, char** argv) {
+
+    int verbose = 0;
+    int opt;
+
+    static unsigned char in[MAX_CAVES * CAVESIZE + 1];
+    static unsigned char out[1 + 2 * (MAX_CAVES + 1) + MAX_CAVES * CAVESIZE];
+    unsigned char cells[CAVE_CELLS];
+    unsigned char check[CAVE_CELLS];
+    unsigned long size;
+    int caves, cave, i, at, broken;
+    Stream s;
+    FILE* f;
+
+    while ((opt = getopt(argc, argv, "v")) != -1) {
+        switch (opt) {
+            case 'v': verbose = 1;
+                break;
+            default: usage();
+        }
+    }
+    if (optind != argc - 2) usage();
+
+    f = fopen(argv[optind], "rb");
+    if (!f) {
+        perror(argv[optind]);
+        return 1;
+    }
+    size = fread(in, 1, sizeof (in), f);
+    fclose(f);
+    if (size == 0 || size % CAVESIZE || size > MAX_CAVES * CAVESIZE) {
+        fprintf(stderr, "clmpack: %s: not a whole number of %d byte caves\n", argv[optind], CAVESIZE);
+        return 1;
+    }
+    caves = size / CAVESIZE;
+
+    out[0] = caves;
+    at = 1 + 2 * (caves + 1);
+    for (cave = 0; cave < caves; cave++) {
+        const unsigned char* p = in + cave * CAVESIZE;
+
+        for (i = 0, broken = 0; i < CAVE_CELLS; i++) {
+            cells[i] = (i & 1) ? p[2 + i / 2] & 0x0F : p[2 + i / 2] >> 4;
+            if (cells[i] == EXT_E_ROCK_BROKEN) broken++;
+        }
+        if (broken > CLM_BROKEN_SIZE) {
+            fprintf(stderr, "clmpack: cave %d has %d broken rocks, the game keeps %d\n", cave + 1,
+                    broken, CLM_BROKEN_SIZE);
+            return 1;
+        }
+        pack(cells, &s);
+
+        out[1 + 2 * cave] = at & 0xFF;
+        out[2 + 2 * cave] = at >> 8;
+        out[at++] = p[0];
+        out[at++] = p[1];
+        for (i = 0; i < s.count; i += 2) {
+            out[at++] = (s.nibbles[i] << 4) | (i + 1 < s.count ? s.nibbles[i + 1] : 0);
+        }
+
+        /*Make sure the game reads back what went in*/
+        if (unpack(out + at - (s.count + 1) / 2, check) != s.count || memcmp(cells, check, CAVE_CELLS)) {
+            fprintf(stderr, "clmpack: cave %d does not unpack to itself\n", cave + 1);
+            return 1;
+        }
+        if (verbose) printf("cave %2d: %3d bytes\n", cave + 1, 2 + (s.count + 1) / 2);
+    }
+    out[1 + 2 * caves] = at & 0xFF;
+    out[2 + 2 * caves] = at >> 8;
+
+    f = fopen(argv[optind + 1], "wb");
+    if (!f || fwrite(out, 1, at, f) != (size_t) at || fclose(f)) {
+        perror(argv[optind + 1]);
+        return 1;
+    }
+    printf("%d caves, %lu bytes packed to %d, %d caves of %d bytes on average fit in the %lu bytes saved\n",
+           caves, size, at, (int) ((size - at) / ((double) (at - 1 - 2 * (caves + 1)) / caves)),
+           (at - 1 - 2 * (caves + 1)) / caves, size - at);
+    return 0;
+}
@@ -0,0 +1,641 @@
+/* Curse of the lost miner - cycle profiler for the cartridge image.
+ *
+ * Runs the ROM headless on the a5200 stand-in with scripted or random
+ * controls and charges every CPU cycle to the routine it was spent in.
+ * Routines are found by following JSR/RTS, interrupts/RTI and the BIOS
+ * jumps through the RAM vectors, so the VBI, the DLI handlers and the
+ * RMT player show up on their own. Names come from a cc65 map file
+ * (ld65 -m) or a VICE label file (ld65 -Ln); routines without a name
+ * are listed by address or by the vector that led to them.
+ *
+ *   clmprof [-m map] [-s script] [-b frames] [-n frames] [-r seed] [-t top] [-d] rom
+ *
+ * The script holds one step per line: a frame count and the controls held
+ * for those frames, L R U D (joystick), F (fire), B (bottom fire) and
+ * Kn (keypad key n, 10 is *, 13 pause). Lines starting with # are
+ * ignored. Without a script the fire button is pressed once the menu is
+ * up. When the script is over, the controls stay centered or, with -r,
+ * go random. With -b the first frames run without being counted, to
+ * look at a single moment such as a cave being set up.
+ *
+ * -d checks the DLIs and fails when a handler reaches WSYNC only after
+ * the line its DLI came on, or is still running when the next DLI comes.
+ * With a map that names the DLI table of rmt_sup.s (_dliStart, _dliPf0,
+ * _dliFont), it also checks that the DLIs of each frame take the entries
+ * in order from the one the VBI starts at: the first COLPF0 and CHBASE
+ * each handler stores must be those of its entry.
+ */
+
+#include <ctype.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "a5200.h"
+
+#define MAX_DEPTH (256)
+#define NAME_SIZE (40)
+
+/*Frame rate of the NTSC console*/
+#define FRAMES_PER_SECOND (59.92)
+
+static const char* const defaultScript = "120\n5 F\n";
+
+/*A routine seen as the target of a call, an interrupt or a vector*/
+typedef struct {
+    unsigned short entry;
+    char name[NAME_SIZE];
+    unsigned long long calls;
+    unsigned long long self;
+    unsigned long long inclusive;
+    unsigned long long frameInclusive;
+    unsigned long long maxFrameInclusive;
+    unsigned int active;
+} Routine;
+
+/*Activation on the shadow call stack*/
+typedef struct {
+    int routine;
+    int entrySp;
+    unsigned long long start;
+} Activation;
+
+typedef struct {
+    Routine* routines;
+    int routineCount;
+    int routineCapacity;
+    int routineIndex[65536];
+    char* symbols[65536];
+
+    Activation stack[MAX_DEPTH];
+    int depth;
+    unsigned long overflow;
+    unsigned long long last;
+
+    /*Counting starts after this frame*/
+    unsigned long skip;
+    unsigned long long skipCpu, skipDma, skipWsync;
+} Profile;
+
+/*DLI check, see -d*/
+typedef struct {
+    int on;
+    unsigned short start, pf0, font; /*DLI table in the map, 0 when not named*/
+    int framed; /*A VBI came, base is known*/
+    unsigned char base; /*_dliStart as the VBI found it*/
+    int index; /*DLI of the frame, counted from the VBI*/
+    int pf0Seen, fontSeen;
+    unsigned long outOfOrder;
+    unsigned long firstFrame; /*Of the first DLI found wrong, plus one*/
+} DliCheck;
+
+/*One line of the input script*/
+typedef struct {
+    unsigned long frames;
+    A5200Input input;
+} ScriptStep;
+
+static A5200 machine;
+static Profile profile;
+static DliCheck dliCheck;
+
+static const struct {
+    unsigned short address;
+    const char* name;
+} vectorNames[] = {
+    {0x200, "VIMIRQ"}, {0x202, "VVBLKI"}, {0x204, "VVBLKD"}, {0x206, "VDSLST"},
+    {0x208, "VKYBDI"}, {0x20A, "VKYBDF"}, {0x20C, "VTRIGR"}, {0x20E, "VBRKOP"}
+};
+
+static const struct {
+    unsigned short address;
+    const char* name;
+} builtinNames[] = {
+    {A5200_BIOS_NMI, "BIOS NMI"},
+    {A5200_BIOS_IMMEDIATE_VBI, "BIOS immediate VBI"},
+    {A5200_BIOS_IRQ, "BIOS IRQ"},
+    {A5200_BIOS_IRQ_DISPATCH, "BIOS IRQ dispatch"},
+    {A5200_BIOS_KEYBOARD, "BIOS keypad"},
+    {A5200_BIOS_EXIT, "BIOS exit"},
+    /*The RMT player where older images copied it to RAM. Newer ones
+     *run it from ROM and name rmtInit, rmtPlay, rmtP3 and rmtSfx in the map
+     */
+    {0x2000, "RMT init (jsr 8192)"},
+    {0x2003, "RMT play (jsr 8195)"},
+    {0x2006, "RMT stop (jsr 8198)"},
+    {0x200F, "RMT sfx (jsr 8207)"}
+};
+
+/*Symbols*/
+
+static void addSymbol(Profile* p, unsigned long address, const char* name) {
+    char** s = &p->symbols[address & 0xFFFF];
+
+    /*C functions win over assembler labels at the same address*/
+    if (*s && !(name[0] == '_' && (*s)[0] != '_')) return;
+    free(*s);
+    *s = strdup(name);
+}
+
+static int isHex6(const char* s) {
+    int i;
+
+    for (i = 0; i < 6; i++) {
+        if (!isxdigit((unsigned char) s[i])) return 0;
+    }
+    return s[6] == 0;
+}
+
+static int isFlags(const char* s) {
+    if (!*s) return 0;
+    for (; *s; s++) {
+        if (!isupper((unsigned char) *s)) return 0;
+    }
+    return 1;
+}
+
+/*ld65 map (name, 6 digit value, flags triplets) or VICE labels (al ADDR .name)*/
+static int loadSymbols(Profile* p, const char* path) {
+    FILE* f = fopen(path, "r");
+    char line[512];
+    char* tokens[16];
+    char* t;
+    int n, i, count = 0;
+    unsigned long address;
+
+    if (!f) return -1;
+    while (fgets(line, sizeof (line), f)) {
+        n = 0;
+        for (t = strtok(line, " \t\r\n"); t && n < 16; t = strtok(NULL, " \t\r\n")) tokens[n++] = t;
+
+        if (n == 3 && !strcmp(tokens[0], "al")) {
+            t = strchr(tokens[1], ':');
+            address = strtoul(t ? t + 1 : tokens[1], NULL, 16);
+            addSymbol(p, address, tokens[2] + (tokens[2][0] == '.'));
+            count++;
+            continue;
+        }
+
+        for (i = 0; i + 2 < n; i++) {
+            if (isHex6(tokens[i + 1]) && isFlags(tokens[i + 2])) {
+                addSymbol(p, strtoul(tokens[i + 1], NULL, 16), tokens[i]);
+                count++;
+                i += 2;
+            }
+        }
+    }
+    fclose(f);
+    return count;
+}
+
+/*Routines*/
+
+static int routineFor(Profile* p, unsigned short entry, const char* how) {
+    Routine* r;
+    unsigned int i;
+
+    if (p->routineIndex[entry]) return p->routineIndex[entry] - 1;
+
+    if (p->routineCount == p->routineCapacity) {
+        p->routineCapacity = p->routineCapacity ? p->routineCapacity * 2 : 256;
+        p->routines = realloc(p->routines, p->routineCapacity * sizeof (Routine));
+        if (!p->routines) {
+            perror("clmprof");
+            exit(1);
+        }
+    }
+    r = &p->routines[p->routineCount];
+    memset(r, 0, sizeof (*r));
+    r->entry = entry;
+
+    if (p->symbols[entry]) {
+        snprintf(r->name, NAME_SIZE, "%s", p->symbols[entry]);
+    } else {
+        snprintf(r->name, NAME_SIZE, "%s$%04X", how ? how : "", entry);
+        for (i = 0; i < sizeof (builtinNames) / sizeof (builtinNames[0]); i++) {
+            if (builtinNames[i].address == entry) snprintf(r->name, NAME_SIZE, "%s", builtinNames[i].name);
+        }
+    }
+
+    p->routineIndex[entry] = ++p->routineCount;
+    return p->routineCount - 1;
+}
+
+/*Charge the cycles since the last event to the routine on top*/
+static void charge(Profile* p, unsigned long long now) {
+    if (p->depth) p->routines[p->stack[p->depth - 1].routine].self += now - p->last;
+    p->last = now;
+}
+
+static void enter(Profile* p, unsigned short entry, const char* how, int entrySp, unsigned long long now) {
+    Activation* a;
+    Routine* r;
+
+    charge(p, now);
+    if (p->depth == MAX_DEPTH) {
+        p->overflow++;
+        return;
+    }
+    a = &p->stack[p->depth++];
+    a->routine = routineFor(p, entry, how);
+    a->entrySp = entrySp;
+    a->start = now;
+    r = &p->routines[a->routine];
+    r->calls++;
+    r->active++;
+}
+
+static void leave(Profile* p, unsigned long long now) {
+    Activation* a = &p->stack[--p->depth];
+    Routine* r = &p->routines[a->routine];
+
+    /*Recursion counts once*/
+    if (--r->active == 0) r->frameInclusive += now - a->start;
+}
+
+static void traceCall(void* ctx, const A5200* m, unsigned short target, unsigned char sp) {
+    enter(ctx, target, NULL, sp, m->cpuCycles);
+}
+
+static void traceInterrupt(void* ctx, const A5200* m, unsigned short target, unsigned char sp) {
+    enter(ctx, target, NULL, sp, m->cpuCycles);
+}
+
+/*A jump through a RAM vector ends the BIOS part, the target takes over*/
+static void traceVectorJump(void* ctx, const A5200* m, unsigned short vector, unsigned short target) {
+    Profile* p = ctx;
+    char how[NAME_SIZE];
+    unsigned int i;
+    int entrySp;
+
+    if (!p->depth) return;
+    snprintf(how, NAME_SIZE, "$%04X ", vector);
+    for (i = 0; i < sizeof (vectorNames) / sizeof (vectorNames[0]); i++) {
+        if (vectorNames[i].address == vector) snprintf(how, NAME_SIZE, "%s ", vectorNames[i].name);
+    }
+
+    /*JMP (ind) takes 5 cycles, they belong to the BIOS*/
+    charge(p, m->cpuCycles + 5);
+    entrySp = p->stack[p->depth - 1].entrySp;
+    leave(p, m->cpuCycles + 5);
+    enter(p, target, how, entrySp, m->cpuCycles + 5);
+}
+
+/*RTS and RTI take 6 cycles, they belong to the routine that returns*/
+static void traceReturn(void* ctx, const A5200* m, unsigned char sp) {
+    Profile* p = ctx;
+    unsigned long long now = m->cpuCycles + 6;
+
+    charge(p, now);
+    while (p->depth > 1 && p->stack[p->depth - 1].entrySp <= sp) leave(p, now);
+}
+
+static void traceFrameEnd(void* ctx, const A5200* m) {
+    Profile* p = ctx;
+    unsigned long long now = m->cpuCycles;
+    Routine* r;
+    int i, j;
+
+    charge(p, now);
+
+    /*Split the activations still running at the frame boundary, only the
+     *outermost activation of a routine counts
+     */
+    for (i = 0; i < p->depth; i++) {
+        for (j = 0; j < i && p->stack[j].routine != p->stack[i].routine; j++);
+        if (j == i) p->routines[p->stack[i].routine].frameInclusive += now - p->stack[i].start;
+        p->stack[i].start = now;
+    }
+
+    for (i = 0; i < p->routineCount; i++) {
+        r = &p->routines[i];
+        r->inclusive += r->frameInclusive;
+        if (r->frameInclusive > r->maxFrameInclusive) r->maxFrameInclusive = r->frameInclusive;
+        r->frameInclusive = 0;
+    }
+
+    /*Forget what happened before the frames of interest*/
+    if (m->frame == p->skip) {
+        for (i = 0; i < p->routineCount; i++) {
+            r = &p->routines[i];
+            r->calls = r->self = r->inclusive = r->maxFrameInclusive = 0;
+        }
+        p->overflow = 0;
+        p->skipCpu = m->cpuCycles;
+        p->skipDma = m->dmaCycles;
+        p->skipWsync = m->wsyncCycles;
+    }
+}
+
+/*DLI check*/
+
+static unsigned short findSymbol(const Profile* p, const char* name) {
+    unsigned int a;
+
+    for (a = 0; a < 65536; a++) {
+        if (p->symbols[a] && !strcmp(p->symbols[a], name)) return (unsigned short) a;
+    }
+    return 0;
+}
+
+/*A DLI that did not take its entry, the frame of the first kept*/
+static void dliWrong(DliCheck* d, const A5200* m) {
+    if (!d->outOfOrder++) d->firstFrame = m->frame + 1;
+}
+
+static void traceNmi(void* ctx, const A5200* m, int dli) {
+    DliCheck* d = &dliCheck;
+
+    (void) ctx;
+    if (!d->on || !d->start) return;
+    /*The DLI before left its band without colors*/
+    if (d->framed && d->index >= 0 && !d->pf0Seen) dliWrong(d, m);
+    if (dli) {
+        d->index++;
+        d->pf0Seen = d->fontSeen = 0;
+    } else {
+        d->framed = 1;
+        d->base = m->mem[d->start];
+        d->index = -1;
+    }
+}
+
+/*The first COLPF0 and CHBASE a DLI handler stores come from its entry.
+ *Font 0 in the table is the cave font, which the handler looks up
+ */
+static void traceIoWrite(void* ctx, const A5200* m, unsigned short addr, unsigned char v) {
+    DliCheck* d = &dliCheck;
+    unsigned char e;
+
+    (void) ctx;
+    if (!d->on || !d->start || !d->framed || m->dliLine < 0) return;
+    e = (unsigned char) (d->base + d->index);
+    if ((addr >> 8) == 0xC0 && (addr & 0x1F) == 0x16 && !d->pf0Seen) {
+        d->pf0Seen = 1;
+        if (v != m->mem[(unsigned short) (d->pf0 + e)]) dliWrong(d, m);
+    } else if ((addr >> 8) == 0xD4 && (addr & 0x0F) == 0x09 && !d->fontSeen) {
+        d->fontSeen = 1;
+        if (m->mem[(unsigned short) (d->font + e)] && v != m->mem[(unsigned short) (d->font + e)]) dliWrong(d, m);
+    }
+}
+
+/*Report of the check, returns 1 when it failed*/
+static int reportDli(const DliCheck* d, const A5200* m) {
+    printf("\nDLIs: %.2f per frame, %lu late, %lu nested", (double) m->dlis / m->frame,
+           m->dliLate, m->dliNested);
+    if (d->start) {
+        printf(", %lu out of table order", d->outOfOrder);
+        if (d->outOfOrder) printf(" (first in frame %lu)", d->firstFrame - 1);
+    } else {
+        printf(", table order not checked, the map does not name it");
+    }
+    putchar('\n');
+    return m->dliLate || m->dliNested || d->outOfOrder;
+}
+
+static const A5200Trace profileTrace = {
+    traceCall, traceInterrupt, traceVectorJump, traceReturn, traceFrameEnd, traceNmi, traceIoWrite
+};
+
+/*Input*/
+
+static int parseStep(char* line, ScriptStep* step) {
+    char* t;
+    char* end;
+
+    t = strtok(line, " \t\r\n");
+    if (!t || t[0] == '#') return 0;
+    step->frames = strtoul(t, &end, 10);
+    if (*end || !step->frames) return -1;
+
+    step->input.potX = step->input.potY = A5200_POT_CENTER;
+    step->input.trigger = step->input.trigger2 = 0;
+    step->input.key = A5200_KEY_NONE;
+
+    for (t = strtok(NULL, " \t\r\n"); t; t = strtok(NULL, " \t\r\n")) {
+        for (; *t; t++) {
+            switch (toupper((unsigned char) *t)) {
+                case 'L': step->input.potX = A5200_POT_MIN;
+                    break;
+                case 'R': step->input.potX = A5200_POT_MAX;
+                    break;
+                case 'U': step->input.potY = A5200_POT_MIN;
+                    break;
+                case 'D': step->input.potY = A5200_POT_MAX;
+                    break;
+                case 'F': step->input.trigger = 1;
+                    break;
+                case 'B': step->input.trigger2 = 1;
+                    break;
+                case 'K':
+                    step->input.key = (unsigned char) strtoul(t + 1, &end, 10);
+                    if (end == t + 1 || step->input.key > 15) return -1;
+                    t = end - 1;
+                    break;
+                default:
+                    return -1;
+            }
+        }
+    }
+    return 1;
+}
+
+static ScriptStep* loadScript(const char* path, int* count) {
+    FILE* f = path ? fopen(path, "r") : fmemopen((void*) defaultScript, strlen(defaultScript), "r");
+    ScriptStep* steps = NULL;
+    char line[256];
+    int n = 0, lineNumber = 0, rc;
+
+    if (!f) return NULL;
+    while (fgets(line, sizeof (line), f)) {
+        lineNumber++;
+        steps = realloc(steps, (n + 1) * sizeof (ScriptStep));
+        rc = parseStep(line, &steps[n]);
+        if (rc < 0) {
+            fprintf(stderr, "clmprof: %s:%d: bad script line\n", path ? path : "script", lineNumber);
+            exit(1);
+        }
+        n += rc;
+    }
+    fclose(f);
+    *count = n;
+    return steps;
+}
+
+static unsigned long long nextRandom(unsigned long long* seed) {
+    *seed ^= *seed << 13;
+    *seed ^= *seed >> 7;
+    *seed ^= *seed << 17;
+    return *seed;
+}
+
+/*Random joystick and fire held for a random number of frames*/
+static void randomInput(A5200Input* input, unsigned long long* seed, unsigned long* hold) {
+    static const unsigned char pots[] = {A5200_POT_MIN, A5200_POT_CENTER, A5200_POT_MAX, A5200_POT_CENTER};
+    unsigned long long n;
+
+    if (*hold) {
+        (*hold)--;
+        return;
+    }
+    n = nextRandom(seed);
+    input->potX = pots[n & 3];
+    input->potY = pots[(n >> 2) & 3];
+    input->trigger = (n >> 4) & 1;
+    input->trigger2 = 0;
+    input->key = A5200_KEY_NONE;
+    *hold = (n >> 8) & 31;
+}
+
+/*Report*/
+
+static int compareInclusive(const void* a, const void* b) {
+    const Routine* ra = a;
+    const Routine* rb = b;
+
+    if (ra->inclusive != rb->inclusive) return ra->inclusive < rb->inclusive ? 1 : -1;
+    if (ra->self != rb->self) return ra->self < rb->self ? 1 : -1;
+    return ra->entry - rb->entry;
+}
+
+static void report(const Profile* p, const A5200* m, int top, double seconds) {
+    double frames = m->frame - p->skip;
+    unsigned long long cpu = m->cpuCycles - p->skipCpu;
+    unsigned long long dma = m->dmaCycles - p->skipDma;
+    unsigned long long total = cpu + dma;
+    Routine* sorted;
+    int i;
+
+    printf("%lu frames in %.3fs, %.0fx real time", m->frame, seconds,
+           seconds > 0 ? m->frame / FRAMES_PER_SECOND / seconds : 0.0);
+    if (p->skip) printf(", counted from frame %lu on", p->skip);
+    printf("\ncycles per frame: %.0f, CPU %.0f (%.1f%%), ANTIC DMA %.0f (%.1f%%), CPU halted on WSYNC %.0f\n",
+           total / frames, cpu / frames, 100.0 * cpu / total,
+           dma / frames, 100.0 * dma / total, (m->wsyncCycles - p->skipWsync) / frames);
+    if (m->illegal) printf("warning: %lu unknown opcodes executed\n", m->illegal);
+    if (p->overflow) printf("warning: call stack deeper than %d, %lu calls not traced\n", MAX_DEPTH, p->overflow);
+
+    sorted = malloc(p->routineCount * sizeof (Routine));
+    memcpy(sorted, p->routines, p->routineCount * sizeof (Routine));
+    qsort(sorted, p->routineCount, sizeof (Routine), compareInclusive);
+
+    printf("\n%-32s %5s %9s %9s %9s %9s\n", "routine", "entry", "calls/f", "incl/f", "self/f", "max incl");
+    for (i = 0; i < p->routineCount && i < top; i++) {
+        printf("%-32s  %04X %9.2f %9.0f %9.0f %9llu\n", sorted[i].name, sorted[i].entry,
+               sorted[i].calls / frames, sorted[i].inclusive / frames, sorted[i].self / frames,
+               sorted[i].maxFrameInclusive);
+    }
+    free(sorted);
+}
+
+static void usage(void) {
+    fprintf(stderr, "usage: clmprof [-m map] [-s script] [-b frames] [-n frames] [-r seed] [-t top] [-d] rom\n"
+            "  -m map     cc65 map file (ld65 -m) or VICE label file (ld65 -Ln)\n"
+            "  -s script  controls, lines of: frames [L|R|U|D|F|B|Kn]...\n"
+            "  -b frames  frames to run before counting starts\n"
+            "  -n frames  frames to count (default 3600)\n"
+            "  -r seed    random controls once the script is over\n"
+            "  -t top     routines to list (default 30)\n"
+            "  -d         check the DLI handlers, exit 1 when one is late or out of order\n");
+    exit(2);
+}
+
+int main(int argc, char** argv) {
+
+    const char* mapPath = NULL;
+    const char* scriptPath = NULL;
+    unsigned long maxFrames = 3600;
+    unsigned long long seed = 0;
+    int top = 30;
+    int opt, failed = 0;
+
+    static unsigned char rom[32769];
+    unsigned long romSize;
+    FILE* f;
+    ScriptStep* script;
+    int scriptSteps = 0, stepIndex = 0;
+    unsigned long stepLeft = 0, hold = 0;
+    struct timespec t0, t1;
+    double seconds;
+
+    while ((opt = getopt(argc, argv, "m:s:b:n:r:t:d")) != -1) {
+        switch (opt) {
+            case 'm': mapPath = optarg;
+                break;
+            case 's': scriptPath = optarg;
+                break;
+            case 'b': profile.skip = strtoul(optarg, NULL, 10);
+                break;
+            case 'n': maxFrames = strtoul(optarg, NULL, 10);
+                break;
+            case 'r': seed = strtoull(optarg, NULL, 10) | 1;
+                break;
+            case 't': top = atoi(optarg);
+                break;
+            case 'd': dliCheck.on = 1;
+                break;
+            default: usage();
+        }
+    }
+    if (optind != argc - 1) usage();
+
+    f = fopen(argv[optind], "rb");
+    if (!f) {
+        perror(argv[optind]);
+        return 1;
+    }
+    romSize = fread(rom, 1, sizeof (rom), f);
+    fclose(f);
+    if (a5200Init(&machine, rom, romSize) < 0) {
+        fprintf(stderr, "clmprof: %s: not a 4, 8, 16 or 32KB cartridge image\n", argv[optind]);
+        return 1;
+    }
+
+    if (mapPath && loadSymbols(&profile, mapPath) < 0) {
+        perror(mapPath);
+        return 1;
+    }
+    if (dliCheck.on) {
+        dliCheck.start = findSymbol(&profile, "_dliStart");
+        dliCheck.pf0 = findSymbol(&profile, "_dliPf0");
+        dliCheck.font = findSymbol(&profile, "_dliFont");
+        if (!dliCheck.pf0 || !dliCheck.font) dliCheck.start = 0;
+    }
+    script = loadScript(scriptPath, &scriptSteps);
+    if (!script && scriptPath) {
+        perror(scriptPath);
+        return 1;
+    }
+
+    /*The cartridge start runs below everything else*/
+    enter(&profile, machine.pc, "start ", 0x100, 0);
+    machine.trace = &profileTrace;
+    machine.traceCtx = &profile;
+
+    clock_gettime(CLOCK_MONOTONIC, &t0);
+    while (machine.frame < profile.skip + maxFrames) {
+        if (stepLeft == 0 && stepIndex < scriptSteps) {
+            machine.input = script[stepIndex].input;
+            stepLeft = script[stepIndex++].frames;
+        }
+        if (stepLeft) {
+            stepLeft--;
+        } else if (seed) {
+            randomInput(&machine.input, &seed, &hold);
+        } else {
+            machine.input.potX = machine.input.potY = A5200_POT_CENTER;
+            machine.input.trigger = machine.input.trigger2 = 0;
+            machine.input.key = A5200_KEY_NONE;
+        }
+        a5200Frame(&machine);
+    }
+    clock_gettime(CLOCK_MONOTONIC, &t1);
+    seconds = (t1.tv_sec - t0.tv_sec) + (t1.tv_nsec - t0.tv_nsec) / 1e9;
+
+    report(&profile, &machine, top, seconds);
+    if (dliCheck.on) failed = reportDli(&dliCheck, &machine);
+    free(script);
+    return failed;
+}
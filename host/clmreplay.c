@@ -0,0 +1,170 @@
+/* Curse of the lost miner - batch replay runner.
+ *
+ * Replays any number of recordings on all cores and checks each one
+ * against the outcome stored in it.
+ *
+ *   clmreplay [-j threads] [-n frames] [-u] [-q] file...
+ *
+ * Every replay is reported as OK, MISMATCH or NEW (no stored outcome).
+ * With -u the outcome is written back into the files. The exit status
+ * is 1 when any replay mismatched or could not be read.
+ */
+
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "replay.h"
+
+#define STATUS_OK (0)
+#define STATUS_NEW (1)
+#define STATUS_MISMATCH (2)
+#define STATUS_ERROR (3)
+
+static const char* const statusNames[] = {"OK", "NEW", "MISMATCH", "ERROR"};
+static const char* const gameOverNames[] = {"none", "death", "success", "quit"};
+
+typedef struct {
+    ClmResult result;
+    unsigned long long hash;
+    int status;
+} Outcome;
+
+/*Shared between the workers*/
+static char** files;
+static unsigned long fileCount;
+static Outcome* outcomes;
+static unsigned long nextFile;
+static unsigned long maxFrames = 10000000;
+static int update;
+
+static void* worker(void* arg) {
+    unsigned long i;
+    ClmReplay r;
+    Outcome* o;
+
+    (void) arg;
+    clmHostInit();
+
+    /*Take the next file until all are done*/
+    while ((i = __atomic_fetch_add(&nextFile, 1, __ATOMIC_RELAXED)) < fileCount) {
+        o = &outcomes[i];
+        if (clmReplayLoad(&r, files[i])) {
+            o->status = STATUS_ERROR;
+            continue;
+        }
+
+        o->hash = clmReplayPlay(&r, maxFrames, &o->result);
+
+        if ((r.flags & CLM_REPLAY_HAS_RESULT) == 0) {
+            o->status = STATUS_NEW;
+        } else if (r.hash != o->hash || memcmp(&r.result, &o->result, sizeof (ClmResult))) {
+            o->status = STATUS_MISMATCH;
+        } else {
+            o->status = STATUS_OK;
+        }
+
+        if (update && o->status != STATUS_OK) {
+            r.flags |= CLM_REPLAY_HAS_RESULT;
+            r.result = o->result;
+            r.hash = o->hash;
+            if (clmReplaySave(&r, files[i])) o->status = STATUS_ERROR;
+        }
+        clmReplayFree(&r);
+    }
+    return NULL;
+}
+
+static void usage(void) {
+    fprintf(stderr, "usage: clmreplay [-j threads] [-n frames] [-u] [-q] file...\n"
+            "  -j threads  worker threads (default: all cores)\n"
+            "  -n frames   frame limit per replay (default 10000000)\n"
+            "  -u          store the outcome in the replay files\n"
+            "  -q          report only replays that are not OK\n");
+    exit(2);
+}
+
+int main(int argc, char** argv) {
+
+    long threads = sysconf(_SC_NPROCESSORS_ONLN);
+    int quiet = 0;
+    int opt;
+    int failed = 0;
+    long t;
+    unsigned long i;
+    unsigned long counts[4] = {0, 0, 0, 0};
+    unsigned long long totalFrames = 0;
+    pthread_t* pool;
+    struct timespec t0, t1;
+    double seconds;
+    Outcome* o;
+
+    while ((opt = getopt(argc, argv, "j:n:uq")) != -1) {
+        switch (opt) {
+            case 'j':
+                threads = atol(optarg);
+                break;
+            case 'n':
+                maxFrames = strtoul(optarg, NULL, 0);
+                break;
+            case 'u':
+                update = 1;
+                break;
+            case 'q':
+                quiet = 1;
+                break;
+            default:
+                usage();
+        }
+    }
+    if (optind == argc) usage();
+    if (threads < 1) threads = 1;
+
+    files = argv + optind;
+    fileCount = argc - optind;
+    if ((unsigned long) threads > fileCount) threads = fileCount;
+    outcomes = calloc(fileCount, sizeof (Outcome));
+    pool = calloc(threads, sizeof (pthread_t));
+    if (outcomes == NULL || pool == NULL) {
+        perror("clmreplay");
+        return 1;
+    }
+
+    clock_gettime(CLOCK_MONOTONIC, &t0);
+    for (t = 0; t < threads; t++) {
+        if (pthread_create(&pool[t], NULL, worker, NULL)) {
+            perror("pthread_create");
+            return 1;
+        }
+    }
+    for (t = 0; t < threads; t++) pthread_join(pool[t], NULL);
+    clock_gettime(CLOCK_MONOTONIC, &t1);
+
+    for (i = 0; i < fileCount; i++) {
+        o = &outcomes[i];
+        counts[o->status]++;
+        if (o->status == STATUS_ERROR) {
+            failed = 1;
+            fprintf(stderr, "%s: cannot read or write replay\n", files[i]);
+            continue;
+        }
+        if (o->status == STATUS_MISMATCH) failed = 1;
+        totalFrames += o->result.frames;
+        if (quiet && o->status == STATUS_OK) continue;
+        printf("%s: %s, cave %d, %lu frames, hash %016llx %s\n", files[i],
+                gameOverNames[o->result.gameOverType], o->result.caveReached + 1,
+                o->result.frames, o->hash, statusNames[o->status]);
+    }
+
+    seconds = (t1.tv_sec - t0.tv_sec) + (t1.tv_nsec - t0.tv_nsec) / 1e9;
+    printf("%lu replays (%lu ok, %lu new, %lu mismatch, %lu error), %llu frames, "
+            "%ld threads, %.3f s, %.0f frames/s\n",
+            fileCount, counts[STATUS_OK], counts[STATUS_NEW], counts[STATUS_MISMATCH],
+            counts[STATUS_ERROR], totalFrames, threads, seconds,
+            seconds > 0 ? totalFrames / seconds : 0.0);
+
+    return failed;
+}
@@ -0,0 +1,198 @@
+/* Curse of the lost miner - RMT module to assembler source.
+ *
+ * Raster Music Tracker saves a module for one fixed address. The game
+ * used to copy it to that address in RAM at power-on. This turns the
+ * module into ca65 source where every address in it is written relative
+ * to a label, so the linker can leave the music in the cartridge:
+ *
+ *   bytes 0..7        "RMT4", track length, speed, player rate, version
+ *   bytes 8..15       addresses of the instrument table, the low and the
+ *                     high bytes of the track addresses and the song
+ *   instrument table  an address per instrument, 0 for none
+ *   track tables      low bytes, then high bytes
+ *   song              four track numbers a line, a line starting with
+ *                     $FE jumps to the address in its last two bytes
+ *
+ * Instruments and tracks hold no addresses. The module is written from
+ * the address it was saved for, found from the instrument table that
+ * follows the header.
+ *
+ *   clmrmt [-l label] module.bin module.s
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#define MAX_SIZE (16384)
+#define HEADER_SIZE (16)
+
+#define SONG_GOTO (0xFE)
+
+/*What each byte of the module is*/
+#define B_DATA (0)
+#define B_WORD (1) /*Address, low byte first*/
+#define B_WORD_HIGH (2)
+#define B_LOW (3) /*Low byte of an address, pairOf has the high byte*/
+#define B_HIGH (4)
+
+static unsigned char module[MAX_SIZE];
+static unsigned char kind[MAX_SIZE];
+static unsigned int pairOf[MAX_SIZE]; /*Other byte of a split address*/
+static unsigned long size;
+static unsigned int origin;
+
+static unsigned int word(unsigned int at) {
+    return module[at] | (module[at + 1] << 8);
+}
+
+/*Offset of an address in the module, -1 when it points outside*/
+static long offsetOf(unsigned int address) {
+    if (address < origin || address >= origin + size) return -1;
+    return address - origin;
+}
+
+static int markWord(unsigned int at, const char* what) {
+    unsigned int address = word(at);
+
+    if (address == 0) return 0;
+    if (offsetOf(address) < 0) {
+        fprintf(stderr, "clmrmt: %s at offset %u points outside the module\n", what, at);
+        return -1;
+    }
+    kind[at] = B_WORD;
+    kind[at + 1] = B_WORD_HIGH;
+    return 0;
+}
+
+static int parse(void) {
+    unsigned int instruments, trackLow, trackHigh, song;
+    unsigned int i, tracks;
+
+    if (size < HEADER_SIZE || memcmp(module, "RMT4", 4)) {
+        fprintf(stderr, "clmrmt: not an RMT4 module\n");
+        return -1;
+    }
+    instruments = word(8);
+    origin = instruments - HEADER_SIZE;
+
+    trackLow = word(10);
+    trackHigh = word(12);
+    song = word(14);
+    if (offsetOf(trackLow) < 0 || offsetOf(trackHigh) < 0 || offsetOf(song) < 0
+            || trackLow < instruments || trackHigh < trackLow || song < trackHigh + (trackHigh - trackLow)) {
+        fprintf(stderr, "clmrmt: the tables in the header are out of order\n");
+        return -1;
+    }
+
+    for (i = 8; i < HEADER_SIZE; i += 2) {
+        if (markWord(i, "header address")) return -1;
+    }
+    for (i = instruments - origin; i < trackLow - origin; i += 2) {
+        if (markWord(i, "instrument")) return -1;
+    }
+
+    tracks = trackHigh - trackLow;
+    for (i = 0; i < tracks; i++) {
+        unsigned int lo = trackLow - origin + i;
+        unsigned int hi = trackHigh - origin + i;
+        unsigned int address = module[lo] | (module[hi] << 8);
+
+        if (module[hi] == 0) continue;
+        if (offsetOf(address) < 0) {
+            fprintf(stderr, "clmrmt: track %u points outside the module\n", i);
+            return -1;
+        }
+        kind[lo] = B_LOW;
+        kind[hi] = B_HIGH;
+        pairOf[lo] = hi;
+        pairOf[hi] = lo;
+    }
+
+    for (i = song - origin; i + 4 <= size; i += 4) {
+        if (module[i] == SONG_GOTO && markWord(i + 2, "song jump")) return -1;
+    }
+    return 0;
+}
+
+static void usage(void) {
+    fprintf(stderr, "usage: clmrmt [-l label] module.bin module.s\n"
+            "  -l label  label of the module (default: _CLM_RMT_MUSIC)\n");
+    exit(2);
+}
+
+int main(int argc, char** argv) {
+
+    const char* label = "_CLM_RMT_MUSIC";
+    const char* name;
+    int opt;
+
+    unsigned int i, column, address;
+    FILE* f;
+
+    while ((opt = getopt(argc, argv, "l:")) != -1) {
+        switch (opt) {
+            case 'l': label = optarg;
+                break;
+            default: usage();
+        }
+    }
+    if (optind != argc - 2) usage();
+
+    f = fopen(argv[optind], "rb");
+    if (!f) {
+        perror(argv[optind]);
+        return 1;
+    }
+    size = fread(module, 1, sizeof (module), f);
+    fclose(f);
+    if (parse()) return 1;
+
+    f = fopen(argv[optind + 1], "w");
+    if (!f) {
+        perror(argv[optind + 1]);
+        return 1;
+    }
+    name = strrchr(argv[optind], '/');
+    fprintf(f, ";Curse of the lost miner - RMT module saved for $%04X, made by clmrmt\n"
+            ";from %s. Addresses are relative to %s\n\n%s:\n", origin,
+            name ? name + 1 : argv[optind], label, label);
+
+    /*Runs of plain bytes, 16 a line, each address on a line of its own*/
+    column = 0;
+    for (i = 0; i < size; i++) {
+        if (kind[i] != B_DATA && column != 0) {
+            fputc('\n', f);
+            column = 0;
+        }
+        switch (kind[i]) {
+            case B_WORD:
+                fprintf(f, ".word %s+$%04X\n", label, word(i) - origin);
+                i++;
+                break;
+            case B_LOW:
+                address = module[i] | (module[pairOf[i]] << 8);
+                fprintf(f, ".byte <(%s+$%04X)\n", label, address - origin);
+                break;
+            case B_HIGH:
+                address = module[pairOf[i]] | (module[i] << 8);
+                fprintf(f, ".byte >(%s+$%04X)\n", label, address - origin);
+                break;
+            default:
+                fprintf(f, column == 0 ? ".byte $%02X" : ",$%02X", module[i]);
+                if (++column == 16) {
+                    fputc('\n', f);
+                    column = 0;
+                }
+        }
+    }
+    if (column != 0) fputc('\n', f);
+
+    if (fclose(f)) {
+        perror(argv[optind + 1]);
+        return 1;
+    }
+    printf("%lu bytes saved for $%04X, %s\n", size, origin, argv[optind + 1]);
+    return 0;
+}
@@ -0,0 +1,198 @@
+/* Curse of the lost miner - seek in a replay.
+ *
+ * Plays a replay once into a frame history and then shows the state of
+ * the core at the start of each frame asked for: the counters, and the
+ * cave as the core sees it with the miner as M. Handy to look at the
+ * frames before a death in a long replay.
+ *
+ * With -b it reports what the history costs instead: its memory next to
+ * a full snapshot per frame, the time to record a frame and the time of
+ * random seeks, each checked against the state hash taken when the frame
+ * was played.
+ *
+ *   clmseek [-k interval] [-b seeks] replay.clr [frame...]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "history.h"
+#include "replay.h"
+
+static const char* const gameOverNames[] = {"none", "death", "success", "quit"};
+
+/*Hash of every frame as it was played, for -b*/
+typedef struct {
+    ClmHistoryRecorder recorder;
+    unsigned long long* hashes;
+    unsigned long capacity;
+} HashRecorder;
+
+static unsigned char hashInput(unsigned long frame, void* ctx) {
+    HashRecorder* rec = ctx;
+
+    if (frame == rec->capacity) {
+        rec->capacity = rec->capacity ? rec->capacity * 2 : 65536;
+        rec->hashes = realloc(rec->hashes, rec->capacity * sizeof (*rec->hashes));
+        if (rec->hashes == NULL) {
+            perror("clmseek");
+            exit(1);
+        }
+    }
+    rec->hashes[frame] = clmHostHash();
+    return clmHistoryRecordInput(frame, &rec->recorder);
+}
+
+static void printFrame(unsigned long frame) {
+    static const char glyphs[] = " #<>[]~H^v***1234567800";
+    unsigned char x, y;
+
+    printf("frame %lu: cave %d, lives %d, diamonds %d/%d, miner %d,%d, delay %d\n"
+            "  fall counter %d length %d flags %d lock %d, jump type %d phase %d ticks %d side %d\n",
+            frame, clm.currentCave + 1, clm.lives, clm.diamondsCollected, clm.diamondsInCave,
+            clm.minerX, clm.minerY, clm.mvDelay, clm.fallCounter, clm.fallLength,
+            clm.fallMovementFlags, clm.landLock, clm.jumpType, clm.jumpPhase, clm.jumpTicks,
+            clm.jumpSideMoved);
+    for (y = 0; y < CAVE_HEIGHT; y++) {
+        for (x = 0; x < CAVE_WIDTH; x++) {
+            if (x == clm.minerX && y == clm.minerY) {
+                putchar('M');
+            } else {
+                putchar(glyphs[clm.caveElements[CLM_CELL(x, y)]]);
+            }
+        }
+        putchar('\n');
+    }
+}
+
+static double nanoseconds(const struct timespec* t0, const struct timespec* t1) {
+    return (t1->tv_sec - t0->tv_sec) * 1e9 + (t1->tv_nsec - t0->tv_nsec);
+}
+
+/*Random frames, each timed and checked*/
+static int benchSeek(const ClmHistory* h, const unsigned long long* hashes, unsigned long seeks) {
+    unsigned long long seed = 42;
+    unsigned long i, frame, wrong = 0;
+    struct timespec t0, t1;
+    double ns, total = 0, worst = 0;
+
+    for (i = 0; i < seeks; i++) {
+        seed ^= seed << 13;
+        seed ^= seed >> 7;
+        seed ^= seed << 17;
+        frame = seed % h->frames;
+
+        clock_gettime(CLOCK_MONOTONIC, &t0);
+        clmHistorySeek(h, frame);
+        clock_gettime(CLOCK_MONOTONIC, &t1);
+
+        ns = nanoseconds(&t0, &t1);
+        total += ns;
+        if (ns > worst) worst = ns;
+        if (clmHostHash() != hashes[frame]) {
+            if (wrong++ == 0) fprintf(stderr, "clmseek: frame %lu does not match\n", frame);
+        }
+    }
+    printf("%lu seeks: %.2f us mean, %.2f us worst, %lu wrong\n", seeks, total / seeks / 1e3,
+            worst / 1e3, wrong);
+    return wrong != 0;
+}
+
+static void usage(void) {
+    fprintf(stderr, "usage: clmseek [-k interval] [-b seeks] replay.clr [frame...]\n"
+            "  -k interval  frames from one keyframe to the next (default %d)\n"
+            "  -b seeks     report memory and time of recording and of random seeks\n",
+            CLM_HISTORY_INTERVAL);
+    exit(2);
+}
+
+int main(int argc, char** argv) {
+
+    unsigned long interval = CLM_HISTORY_INTERVAL;
+    unsigned long seeks = 0;
+    unsigned long maxFrames;
+    int opt;
+    int failed = 0;
+
+    int a;
+    unsigned long frame;
+    char* end;
+    struct timespec t0, t1;
+    double seconds;
+    ClmReplay r;
+    ClmReplayCursor c;
+    ClmHistory h;
+    ClmResult result;
+    HashRecorder rec;
+
+    while ((opt = getopt(argc, argv, "k:b:")) != -1) {
+        switch (opt) {
+            case 'k':
+                interval = strtoul(optarg, NULL, 0);
+                if (interval == 0) usage();
+                break;
+            case 'b':
+                seeks = strtoul(optarg, NULL, 0);
+                if (seeks == 0) usage();
+                break;
+            default:
+                usage();
+        }
+    }
+    if (optind >= argc) usage();
+
+    if (clmReplayLoad(&r, argv[optind])) {
+        perror(argv[optind]);
+        return 1;
+    }
+    maxFrames = 10000000;
+    if (r.length != 0) maxFrames = r.length;
+
+    clmHostInit();
+    clmHistoryInit(&h, interval);
+    clmReplayRewind(&c, &r);
+    rec.recorder.source = clmReplayInput;
+    rec.recorder.ctx = &c;
+    rec.recorder.history = &h;
+    rec.hashes = NULL;
+    rec.capacity = 0;
+
+    clock_gettime(CLOCK_MONOTONIC, &t0);
+    if (seeks) {
+        clmHostPlay(r.gameType, r.startCave, r.gameSpeed, hashInput, &rec, maxFrames, &result);
+    } else {
+        clmHostPlay(r.gameType, r.startCave, r.gameSpeed, clmHistoryRecordInput, &rec.recorder,
+                maxFrames, &result);
+    }
+    clock_gettime(CLOCK_MONOTONIC, &t1);
+    seconds = nanoseconds(&t0, &t1) / 1e9;
+
+    printf("%s: %s, cave %d, %lu frames recorded, keyframe every %lu\n", argv[optind],
+            gameOverNames[result.gameOverType], result.caveReached + 1, h.frames, h.interval);
+
+    if (seeks && h.frames) {
+        printf("history %lu bytes, %.2f bytes/frame; a snapshot a frame would be %lu bytes/frame\n",
+                clmHistoryBytes(&h), (double) clmHistoryBytes(&h) / h.frames,
+                (unsigned long) CLM_SNAPSHOT_SIZE);
+        printf("played and recorded in %.3f s, %.0f ns/frame, the hashes taken included\n", seconds,
+                seconds * 1e9 / h.frames);
+        failed = benchSeek(&h, rec.hashes, seeks);
+    }
+
+    for (a = optind + 1; a < argc; a++) {
+        frame = strtoul(argv[a], &end, 0);
+        if (*end != '\0' || clmHistorySeek(&h, frame)) {
+            fprintf(stderr, "clmseek: no frame %s, the replay has %lu\n", argv[a], h.frames);
+            failed = 1;
+            continue;
+        }
+        printFrame(frame);
+    }
+
+    free(rec.hashes);
+    clmHistoryFree(&h);
+    clmReplayFree(&r);
+    return failed;
+}
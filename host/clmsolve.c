@@ -0,0 +1,1063 @@
+/* Curse of the lost miner - heuristic cave route finder.
+ *
+ * Looks for routes that complete the caves under the real movement rules
+ * by searching over states of the game core itself. Each route found is
+ * checked by playing it on the core and can be written as a replay. It
+ * is not proven the shortest, and a cave it finds no route for is not
+ * proven impossible.
+ *
+ *   clmsolve [-c cave] [-s speed] [-j threads] [-m megabytes] [-w prefix] [-r relax] [-b beam] [-v]
+ *
+ * The search is a uniform-cost search with frames as the cost over the
+ * states in which the miner is at rest (clmMinerAtRest). A move leads
+ * from one such state to the next. It is followed frame by frame with
+ * every input the core tells apart in each frame the core reads the
+ * input, so moves take in drifts, presses of down in a fall and waits of
+ * a single frame on broken rock; the states within a move are merged
+ * when the same one is reached again no earlier.
+ *
+ * A state is the core state less what cannot change the frames to come:
+ * the game settings and the undo log, and at rest the counters of the
+ * last move (settle). It is stored in compact form, miner and physics
+ * counters plus the collected diamond bitset, removed unstable rocks and
+ * the decay stage and timer of every broken rock, and each compact state
+ * is checked to give the core state back. States that differ in the
+ * diamonds only share a place in a lock-free open addressing table that
+ * holds the places themselves, so no two states are ever confused. Every
+ * place keeps, under one of a set of striped locks, the diamond sets it
+ * was reached with. A state is dropped when the same place was reached
+ * no later with the same diamonds or more.
+ *
+ * By default only the most promising states of every frame are
+ * expanded (-b), those with the most diamonds and nearest to the next.
+ * -r 1 and up also tell broken rocks apart by their decay stage only and
+ * keep the first state reached. With -b 0 -r 0 the search is exact: a
+ * route found is the shortest and a search that runs out of states
+ * proves the cave cannot be completed, but the caves of the game outgrow
+ * memory long before that (the training cave 4 GB at frame 224), and
+ * are then reported as without a route.
+ *
+ * States are kept in buckets by frame. All workers expand the current
+ * bucket together, each taking the next chunk of states as soon as it
+ * is done with the last one, and file successors into per-worker lists
+ * of later buckets, so the buckets need no locks.
+ *
+ * With -w the route of every completed cave is written as a replay that
+ * clmreplay can verify.
+ */
+
+#include <pthread.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "replay.h"
+
+#define MAX_DIAMONDS (64)
+#define MAX_UNSTABLE (32)
+#define MAX_THREADS (64)
+
+/*Successors are never more than this many frames ahead*/
+#define BUCKETS (256)
+#define MAX_RUN (BUCKETS - 1)
+
+/*Broken rock that has crumbled away*/
+#define BROKEN_GONE (0xFF)
+
+/*Every input the core tells apart. Up with left or right is left or
+ *right, down with fire is down and fire alone is center. Center, left and
+ *right come first, they are all a high jump reads
+ */
+static const unsigned char inputs[] = {
+    JS_LOG_CENTER, JS_LOG_LEFT, JS_LOG_RIGHT, JS_LOG_UP, JS_LOG_DOWN,
+    JS_LOG_LEFT | JS_LOG_FIRE, JS_LOG_RIGHT | JS_LOG_FIRE, JS_LOG_UP | JS_LOG_FIRE
+};
+#define INPUT_COUNT (sizeof (inputs))
+
+/*A state of the cave, everything that can differ from the cave as loaded.
+ *All but the diamonds is the place of the state
+ */
+typedef struct {
+    unsigned long long diamonds; /*Collected*/
+    unsigned int unstable; /*Crumbled away*/
+    unsigned char minerX;
+    unsigned char minerY;
+    unsigned char mvDelay;
+    unsigned char fallCounter;
+    unsigned char fallLength;
+    unsigned char fallMovementFlags;
+    unsigned char landLock;
+    unsigned char jumpType;
+    unsigned char jumpPhase;
+    unsigned char jumpTicks;
+    unsigned char jumpSideMoved;
+    unsigned char broken[CLM_BROKEN_SIZE]; /*Decay stage << 5 | timer*/
+} Compact;
+
+#define PLACE_OFFSET (offsetof(Compact, unstable))
+
+/*A state waiting in a bucket and how it was reached*/
+typedef struct {
+    Compact state;
+    unsigned int parent; /*Route node of the state it was expanded from*/
+} Entry;
+
+/*Step of a route, a state as it was expanded. The moves between them
+ *are followed again to write the route out
+ */
+typedef struct {
+    Compact state;
+    unsigned int parent;
+    unsigned int frame;
+} Node;
+
+#define NO_NODE (0xFFFFFFFFU)
+
+/*Diamonds collected on the way to a place and the lowest frame*/
+typedef struct {
+    unsigned long long diamonds;
+    unsigned int best;
+    unsigned int expanded;
+} Front;
+
+/*Visited place, with the collections no other collection at that place
+ *beats. The place itself is in places, placeBytes per slot
+ */
+typedef struct {
+    unsigned long long key; /*Fingerprint, 0 for a free slot*/
+    unsigned int stored; /*The place is in places*/
+    unsigned int count;
+    unsigned int capacity;
+    Front* front;
+} Slot;
+
+#define LOCKS (1024)
+
+typedef struct {
+    Entry* entries;
+    size_t count;
+    size_t capacity;
+} List;
+
+/*States of the moves from a state being followed, per worker*/
+#define MOVE_STATES (16384)
+#define MOVE_SLOTS (32768)
+
+/*Core state a step keeps, the undo log only tells how to get back to the
+ *start of the cave
+ */
+#define STEP_BYTES (offsetof(ClmState, undoCount))
+
+typedef struct {
+    ClmState state;
+    Compact key;
+    unsigned short parent;
+    unsigned char at;
+    unsigned char input;
+} Step;
+
+typedef struct {
+    Step steps[MOVE_STATES];
+    unsigned int slotMoves[MOVE_SLOTS]; /*Moves the slot was taken in, older ones are free*/
+    unsigned short slots[MOVE_SLOTS];
+    unsigned int moves; /*Times moves were followed*/
+    unsigned int count;
+} Follow;
+
+/*End of a move, with clm at rest or with the last diamond picked, after
+ *input in frame at of the move from step n. Returns 1 to stop following
+ */
+typedef int (*MoveEnd)(Follow* w, unsigned int n, unsigned char at, unsigned char input, void* ctx);
+
+/*The search expanding a state*/
+typedef struct {
+    unsigned int node;
+    int self;
+} Expansion;
+
+/*A move of the route found, looked for to write the route out*/
+typedef struct {
+    const Compact* to; /*NULL for the move that picks the last diamond*/
+    unsigned int frames;
+    unsigned char* in;
+    int found;
+} Wanted;
+
+/*The cave being solved*/
+static ClmState start;
+static unsigned char diamondCount, unstableCount, brokenCount;
+static unsigned char diamondCells[MAX_DIAMONDS][2];
+static unsigned char unstableCells[MAX_UNSTABLE][2];
+static unsigned char brokenCells[CLM_BROKEN_SIZE][2];
+static size_t placeBytes;
+
+/*Search*/
+static size_t budget;
+static Slot* table;
+static unsigned char* places;
+static size_t tableMask;
+static size_t tableLimit;
+static size_t tableUsed;
+static size_t frontUsed;
+static size_t frontLimit;
+static size_t entriesUsed;
+static size_t entryLimit;
+static pthread_mutex_t locks[LOCKS];
+static Node* nodes;
+static size_t nodeCount;
+static size_t nodeCapacity;
+static List lists[BUCKETS][MAX_THREADS];
+static int threads;
+static int overflow;
+static int truncated;
+static size_t beam = 200;
+static int pruned;
+static int relax;
+static unsigned char brokenMask;
+
+/*How much of the broken rock state tells states apart: timer and stage,
+ *stage, first or second half of the decay, there or gone
+ */
+static const unsigned char relaxMasks[] = {0xFF, 0xE0, 0x80, 0x00};
+
+/*Current bucket, shared by the workers*/
+static unsigned int frame;
+static size_t bucketTotal;
+static size_t bucketNext;
+static pthread_barrier_t barrier;
+static int finished;
+
+/*Best route to the goal so far*/
+static pthread_mutex_t goalLock = PTHREAD_MUTEX_INITIALIZER;
+static unsigned int goalFrame;
+static unsigned int goalNode;
+
+static unsigned long long statesExpanded;
+static unsigned int mostCollected;
+
+static void fail(const char* what) {
+    perror(what);
+    exit(1);
+}
+
+/*Fingerprint of a state, a word at a time*/
+static unsigned long long hashBytes(const void* data, size_t n) {
+    const unsigned char* p = data;
+    unsigned long long h = 0xCBF29CE484222325ULL, w;
+
+    for (; n >= sizeof (w); n -= sizeof (w), p += sizeof (w)) {
+        memcpy(&w, p, sizeof (w));
+        h = (h ^ w) * 0xFF51AFD7ED558CCDULL;
+        h ^= h >> 32;
+    }
+    while (n--) {
+        h ^= *p++;
+        h *= 0x100000001B3ULL;
+    }
+    h ^= h >> 29;
+    return h | 1;
+}
+
+/*Find the cells that can change. Broken rocks are found row after row,
+ *so they line up with the broken rock table of the core
+ */
+static void loadCave(unsigned char cave, unsigned char speed) {
+    unsigned char x, y, e;
+
+    memset(&clm, 0, sizeof (clm));
+    clmNewGame(GAME_TYPE_NORMAL, cave, speed);
+    clmStartCave();
+    start = clm;
+
+    diamondCount = unstableCount = brokenCount = 0;
+    for (y = 0; y < CAVE_HEIGHT; y++) {
+        for (x = 0; x < CAVE_WIDTH; x++) {
+            e = start.caveElements[CLM_CELL(x, y)];
+            if (e >= E_DIAM_F && e <= E_DIAM_L) {
+                if (diamondCount == MAX_DIAMONDS) goto tooBig;
+                diamondCells[diamondCount][0] = x;
+                diamondCells[diamondCount++][1] = y;
+            } else if (e == E_ROCK_UNSTABLE) {
+                if (unstableCount == MAX_UNSTABLE) goto tooBig;
+                unstableCells[unstableCount][0] = x;
+                unstableCells[unstableCount++][1] = y;
+            } else if (e == E_ROCK_BROKEN_F) {
+                if (brokenCount == CLM_BROKEN_SIZE ||
+                        start.brokenCell[brokenCount] != CLM_CELL(x, y)) goto tooBig;
+                brokenCells[brokenCount][0] = x;
+                brokenCells[brokenCount++][1] = y;
+            }
+        }
+    }
+    if (brokenCount != start.brokenCount) goto tooBig;
+    placeBytes = offsetof(Compact, broken) + brokenCount - PLACE_OFFSET;
+    return;
+
+tooBig:
+    fprintf(stderr, "cave %d has changing cells the solver does not know\n", cave + 1);
+    exit(1);
+}
+
+/*Drop what cannot change the frames to come. At rest the counters of
+ *the last fall or jump no longer matter, a movement delay of 1 runs out
+ *before the input is read and a sideways fall only leaves the landing
+ *lock behind
+ */
+static void settle(void) {
+    if (!clmMinerAtRest()) return;
+
+    if (clm.fallMovementFlags & FALL_FLAG_LEFT_AND_RIGHT) clm.landLock = 2;
+    clm.mvDelay = 0;
+    clm.fallCounter = 0;
+    clm.fallLength = 0;
+    clm.fallMovementFlags = FALL_FLAG_NONE;
+    clm.jumpPhase = 0;
+    clm.jumpTicks = 0;
+    clm.jumpSideMoved = 0;
+}
+
+/*Compact state to core state and back*/
+static void decode(const Compact* c) {
+    unsigned char i, x, y;
+
+    clm = start;
+
+    for (i = 0; i < diamondCount; i++) {
+        if (c->diamonds & (1ULL << i)) {
+            clm.caveElements[CLM_CELL(diamondCells[i][0], diamondCells[i][1])] = E_BLANK;
+            clm.diamondsCollected++;
+        }
+    }
+    for (i = 0; i < unstableCount; i++) {
+        if (c->unstable & (1U << i)) {
+            clm.caveElements[CLM_CELL(unstableCells[i][0], unstableCells[i][1])] = E_BLANK;
+        }
+    }
+    for (i = 0; i < brokenCount; i++) {
+        x = brokenCells[i][0];
+        y = brokenCells[i][1];
+        if (c->broken[i] == BROKEN_GONE) {
+            clm.caveElements[CLM_CELL(x, y)] = E_BLANK;
+        } else {
+            clm.caveElements[CLM_CELL(x, y)] = E_ROCK_BROKEN_F + (c->broken[i] >> 5);
+            clm.brokenTicks[i] = c->broken[i] & 0x1F;
+        }
+    }
+
+    clm.minerX = c->minerX;
+    clm.minerY = c->minerY;
+    clm.mvDelay = c->mvDelay;
+    clm.fallCounter = c->fallCounter;
+    clm.fallLength = c->fallLength;
+    clm.fallMovementFlags = c->fallMovementFlags;
+    clm.landLock = c->landLock;
+    clm.jumpType = c->jumpType;
+    clm.jumpPhase = c->jumpPhase;
+    clm.jumpTicks = c->jumpTicks;
+    clm.jumpSideMoved = c->jumpSideMoved;
+}
+
+/*Core state that plays on the same way: the cave, the decay timers and
+ *the cave and miner status, as in clmHostHash
+ */
+static int sameState(const ClmState* a, const ClmState* b) {
+    return memcmp(a->caveElements, b->caveElements, sizeof (a->caveElements)) == 0 &&
+            memcmp(a->brokenTicks, b->brokenTicks, brokenCount) == 0 &&
+            memcmp(&a->diamondsInCave, &b->diamondsInCave,
+            offsetof(ClmState, undoCount) - offsetof(ClmState, diamondsInCave)) == 0;
+}
+
+static void encode(Compact* c) {
+    unsigned char i, x, y, e;
+
+    memset(c, 0, sizeof (*c));
+
+    for (i = 0; i < diamondCount; i++) {
+        if (clm.caveElements[CLM_CELL(diamondCells[i][0], diamondCells[i][1])] == E_BLANK) {
+            c->diamonds |= 1ULL << i;
+        }
+    }
+    for (i = 0; i < unstableCount; i++) {
+        if (clm.caveElements[CLM_CELL(unstableCells[i][0], unstableCells[i][1])] == E_BLANK) {
+            c->unstable |= 1U << i;
+        }
+    }
+    for (i = 0; i < brokenCount; i++) {
+        x = brokenCells[i][0];
+        y = brokenCells[i][1];
+        e = clm.caveElements[CLM_CELL(x, y)];
+        if (e == E_BLANK) {
+            c->broken[i] = BROKEN_GONE;
+        } else {
+            c->broken[i] = ((e - E_ROCK_BROKEN_F) << 5) | clm.brokenTicks[i];
+        }
+    }
+
+    c->minerX = clm.minerX;
+    c->minerY = clm.minerY;
+    c->mvDelay = clm.mvDelay;
+    c->fallCounter = clm.fallCounter;
+    c->fallLength = clm.fallLength;
+    c->fallMovementFlags = clm.fallMovementFlags;
+    c->landLock = clm.landLock;
+    c->jumpType = clm.jumpType;
+    c->jumpPhase = clm.jumpPhase;
+    c->jumpTicks = clm.jumpTicks;
+    c->jumpSideMoved = clm.jumpSideMoved;
+}
+
+/*Nothing of the core state may get lost in a state that is kept*/
+static void checkEncoded(const Compact* c) {
+    ClmState here = clm;
+
+    decode(c);
+    if (!sameState(&clm, &here)) {
+        fprintf(stderr, "clmsolve: the compact state misses part of the core state\n");
+        exit(1);
+    }
+    clm = here;
+}
+
+/*How many of the inputs the core tells apart in the next frame. Unless
+ *the delay runs out only center needs trying, a high jump is steered by
+ *left and right only
+ */
+static unsigned char inputsRead(void) {
+    if (clm.mvDelay > 1) return 1;
+    if (clm.jumpType == JUMP_NONE) return INPUT_COUNT;
+    return clm.jumpType == JUMP_HIGH && clm.jumpSideMoved == 0 ? 3 : 1;
+}
+
+/*The place of a state as the table keys it*/
+static void placeOf(const Compact* c, Compact* k) {
+    unsigned char i;
+
+    *k = *c;
+    if (relax == 0) return;
+
+    /*Relaxed search tells broken rocks apart by decay stage only*/
+    for (i = 0; i < brokenCount; i++) {
+        if (k->broken[i] != BROKEN_GONE) k->broken[i] &= brokenMask;
+    }
+}
+
+/*Slot of a state, NULL when the table is full*/
+static Slot* place(const Compact* c) {
+    Compact k;
+    const unsigned char* p;
+    unsigned long long key, s;
+    size_t i;
+
+    placeOf(c, &k);
+    p = (const unsigned char*) &k + PLACE_OFFSET;
+    key = hashBytes(p, placeBytes);
+    i = key & tableMask;
+
+    while (1) {
+        s = __atomic_load_n(&table[i].key, __ATOMIC_ACQUIRE);
+        if (s == 0) {
+            if (__atomic_fetch_add(&tableUsed, 1, __ATOMIC_RELAXED) >= tableLimit) {
+                overflow = 1;
+                return NULL;
+            }
+            if (__atomic_compare_exchange_n(&table[i].key, &s, key, 0,
+                    __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE)) {
+                memcpy(places + i * placeBytes, p, placeBytes);
+                __atomic_store_n(&table[i].stored, 1, __ATOMIC_RELEASE);
+                return &table[i];
+            }
+            __atomic_fetch_sub(&tableUsed, 1, __ATOMIC_RELAXED);
+        }
+        if (s == key) {
+            while (!__atomic_load_n(&table[i].stored, __ATOMIC_ACQUIRE)) { }
+            if (memcmp(places + i * placeBytes, p, placeBytes) == 0) return &table[i];
+        }
+        i = (i + 1) & tableMask;
+    }
+}
+
+static pthread_mutex_t* lockOf(const Slot* s) {
+    return &locks[(s - table) % LOCKS];
+}
+
+/*Record the state reached at frame f, return 1 unless a state at the same
+ *place with the same or more diamonds was reached no later. Collected
+ *diamonds leave blank cells that behave exactly like the diamonds did,
+ *so such a state can do everything this one can.
+ */
+static int visit(const Compact* c, unsigned int f) {
+    Slot* s = place(c);
+    Front* e;
+    unsigned int i;
+    int added = 0;
+
+    if (s == NULL) return 0;
+
+    pthread_mutex_lock(lockOf(s));
+    for (i = 0; i < s->count; i++) {
+        e = &s->front[i];
+        if ((e->diamonds & c->diamonds) == c->diamonds && e->best <= f) goto done;
+    }
+
+    /*Drop what the new state beats. Those are all later than the current
+     *bucket, so none of them has been expanded
+     */
+    for (i = 0; i < s->count;) {
+        e = &s->front[i];
+        if ((c->diamonds & e->diamonds) == e->diamonds && f <= e->best) {
+            *e = s->front[--s->count];
+            __atomic_fetch_sub(&frontUsed, 1, __ATOMIC_RELAXED);
+        } else {
+            i++;
+        }
+    }
+
+    if (__atomic_fetch_add(&frontUsed, 1, __ATOMIC_RELAXED) >= frontLimit) {
+        overflow = 1;
+        goto done;
+    }
+    if (s->count == s->capacity) {
+        s->capacity = s->capacity ? s->capacity * 2 : 1;
+        s->front = realloc(s->front, s->capacity * sizeof (Front));
+        if (s->front == NULL) fail("clmsolve");
+    }
+    e = &s->front[s->count++];
+    e->diamonds = c->diamonds;
+    e->best = f;
+    e->expanded = 0;
+    added = 1;
+
+done:
+    pthread_mutex_unlock(lockOf(s));
+    return added;
+}
+
+/*Claim a state for expansion at frame f, 0 if it has been beaten since*/
+static int claim(const Compact* c, unsigned int f) {
+    Slot* s = place(c);
+    unsigned int i;
+    int claimed = 0;
+
+    pthread_mutex_lock(lockOf(s));
+    for (i = 0; i < s->count; i++) {
+        if (s->front[i].diamonds == c->diamonds && s->front[i].best == f &&
+                !s->front[i].expanded) {
+            s->front[i].expanded = 1;
+            claimed = 1;
+            break;
+        }
+    }
+    pthread_mutex_unlock(lockOf(s));
+    return claimed;
+}
+
+static void push(List* l, const Entry* e) {
+    if (__atomic_fetch_add(&entriesUsed, 1, __ATOMIC_RELAXED) >= entryLimit) {
+        overflow = 1;
+        return;
+    }
+    if (l->count == l->capacity) {
+        l->capacity = l->capacity ? l->capacity * 2 : 1024;
+        l->entries = realloc(l->entries, l->capacity * sizeof (Entry));
+        if (l->entries == NULL) fail("clmsolve");
+    }
+    l->entries[l->count++] = *e;
+}
+
+static void reachedGoal(unsigned int node, unsigned int f) {
+    pthread_mutex_lock(&goalLock);
+    if (f < goalFrame) {
+        goalFrame = f;
+        goalNode = node;
+    }
+    pthread_mutex_unlock(&goalLock);
+}
+
+/*Keep a state within a move reached at frame at + 1 of it, unless it
+ *was reached before. 0 when there are too many to keep
+ */
+static int keepStep(Follow* w, unsigned int parent, unsigned char at, unsigned char input) {
+    Step* s;
+    unsigned long long h;
+    size_t i;
+
+    if (w->count == MOVE_STATES) return 0;
+    s = &w->steps[w->count];
+    encode(&s->key);
+    h = hashBytes(&s->key, sizeof (s->key));
+    for (i = h & (MOVE_SLOTS - 1); w->slotMoves[i] == w->moves; i = (i + 1) & (MOVE_SLOTS - 1)) {
+        if (memcmp(&w->steps[w->slots[i]].key, &s->key, sizeof (s->key)) == 0) return 1;
+    }
+    w->slotMoves[i] = w->moves;
+    w->slots[i] = (unsigned short) w->count;
+    memcpy(&s->state, &clm, STEP_BYTES);
+    s->parent = (unsigned short) parent;
+    s->at = at;
+    s->input = input;
+    w->count++;
+    return 1;
+}
+
+/*Follow every move from the state in clm, at rest, a frame at a time
+ *until the miner is at rest again. 0 when a move was too long to follow
+ */
+static int followMoves(Follow* w, MoveEnd end, void* ctx) {
+    unsigned int n, begin, last;
+    unsigned char at, i, count;
+
+    if (++w->moves == 0) {
+        memset(w->slotMoves, 0, sizeof (w->slotMoves));
+        w->moves = 1;
+    }
+    memcpy(&w->steps[0].state, &clm, STEP_BYTES);
+    w->count = 1;
+
+    for (at = 0, begin = 0, last = 1; begin < last; at++, begin = last, last = w->count) {
+        if (at == MAX_RUN) return 0;
+        for (n = begin; n < last; n++) {
+            memcpy(&clm, &w->steps[n].state, STEP_BYTES);
+            count = inputsRead();
+            for (i = 0; i < count; i++) {
+                if (i) memcpy(&clm, &w->steps[n].state, STEP_BYTES);
+                clmStep(inputs[i]);
+                if (clm.caveDeath) continue;
+
+                if (clm.caveAllPicked || clmMinerAtRest()) {
+                    if (end(w, n, at, inputs[i], ctx)) return 1;
+                } else if (!keepStep(w, n, at, inputs[i])) {
+                    return 0;
+                }
+            }
+        }
+    }
+    return 1;
+}
+
+/*A move of the search has come to an end*/
+static int endMove(Follow* w, unsigned int n, unsigned char at, unsigned char input, void* ctx) {
+    const Expansion* x = ctx;
+    unsigned int f = frame + at + 1;
+    Entry next;
+
+    (void) w;
+    (void) n;
+    (void) input;
+
+    if (clm.diamondsCollected > mostCollected) mostCollected = clm.diamondsCollected;
+    if (clm.caveAllPicked) {
+        reachedGoal(x->node, f);
+        return 0;
+    }
+    if (f >= goalFrame) return 0;
+
+    settle();
+    encode(&next.state);
+    checkEncoded(&next.state);
+    next.parent = x->node;
+    if (visit(&next.state, f)) push(&lists[f % BUCKETS][x->self], &next);
+    return 0;
+}
+
+/*Try every move from a state at rest*/
+static void expand(const Entry* from, Follow* w, int self) {
+    Expansion x;
+
+    x.node = __atomic_fetch_add(&nodeCount, 1, __ATOMIC_RELAXED);
+    if (x.node >= nodeCapacity) {
+        overflow = 1;
+        return;
+    }
+    x.self = self;
+    nodes[x.node].state = from->state;
+    nodes[x.node].parent = from->parent;
+    nodes[x.node].frame = frame;
+    __atomic_fetch_add(&statesExpanded, 1, __ATOMIC_RELAXED);
+
+    decode(&from->state);
+    if (!followMoves(w, endMove, &x)) truncated = 1;
+}
+
+/*Entry number n of the current bucket*/
+static const Entry* bucketEntry(size_t n) {
+    List* l = lists[frame % BUCKETS];
+    int t = 0;
+
+    while (n >= l[t].count) n -= l[t++].count;
+    return &l[t].entries[n];
+}
+
+static void* worker(void* arg) {
+    int self = (int) (long) arg;
+    size_t n, end;
+    const Entry* e;
+    Follow* w = calloc(1, sizeof (Follow));
+
+    if (w == NULL) fail("clmsolve");
+    clmHostInit();
+
+    while (1) {
+        pthread_barrier_wait(&barrier);
+        if (finished) break;
+
+        /*Take chunks of the current bucket until it is empty*/
+        while ((n = __atomic_fetch_add(&bucketNext, 64, __ATOMIC_RELAXED)) < bucketTotal) {
+            end = n + 64 < bucketTotal ? n + 64 : bucketTotal;
+            for (; n < end && !overflow; n++) {
+                e = bucketEntry(n);
+                if (claim(&e->state, frame)) expand(e, w, self);
+            }
+        }
+        pthread_barrier_wait(&barrier);
+    }
+    free(w);
+    return NULL;
+}
+
+/*How promising a state is: diamonds collected first, then the closer to
+ *the nearest diamond left the better
+ */
+#define RANK_NEAR (64)
+
+static unsigned int rank(const Compact* c) {
+    unsigned int near = RANK_NEAR - 1, d;
+    unsigned char i;
+
+    for (i = 0; i < diamondCount; i++) {
+        if (c->diamonds & (1ULL << i)) continue;
+        d = abs(diamondCells[i][0] - c->minerX) + abs(diamondCells[i][1] - c->minerY);
+        if (d < near) near = d;
+    }
+    return __builtin_popcountll(c->diamonds) * RANK_NEAR + RANK_NEAR - 1 - near;
+}
+
+/*Keep the beam states of the current bucket that rank highest*/
+static void trimBucket(void) {
+    static size_t have[(MAX_DIAMONDS + 1) * RANK_NEAR];
+    List* l = lists[frame % BUCKETS];
+    size_t keep = 0, room, i, n;
+    unsigned int cut, r;
+    int t;
+
+    memset(have, 0, sizeof (have));
+    for (t = 0; t < threads; t++) {
+        for (i = 0; i < l[t].count; i++) have[rank(&l[t].entries[i].state)]++;
+    }
+    for (cut = (diamondCount + 1) * RANK_NEAR - 1; keep + have[cut] < beam; cut--) keep += have[cut];
+    room = beam - keep;
+
+    for (t = 0; t < threads; t++) {
+        for (i = n = 0; i < l[t].count; i++) {
+            r = rank(&l[t].entries[i].state);
+            if (r > cut || (r == cut && room && room--)) l[t].entries[n++] = l[t].entries[i];
+        }
+        entriesUsed -= l[t].count - n;
+        l[t].count = n;
+    }
+    bucketTotal = beam;
+    pruned = 1;
+}
+
+/*Pick the next non-empty bucket, 0 when the search is over*/
+static int nextBucket(void) {
+    unsigned int skipped;
+    int t;
+
+    for (skipped = 0; skipped < BUCKETS; skipped++, frame++) {
+        if (frame >= goalFrame) return 0;
+        bucketTotal = 0;
+        for (t = 0; t < threads; t++) bucketTotal += lists[frame % BUCKETS][t].count;
+        if (bucketTotal) {
+            if (beam && bucketTotal > beam) trimBucket();
+            return 1;
+        }
+    }
+    return 0;
+}
+
+/*The move of the route found, with its inputs*/
+static int endWanted(Follow* w, unsigned int n, unsigned char at, unsigned char input, void* ctx) {
+    Wanted* x = ctx;
+    Compact c;
+
+    if (at + 1U != x->frames || (x->to == NULL) != (clm.caveAllPicked != 0)) return 0;
+    if (x->to) {
+        settle();
+        encode(&c);
+        if (memcmp(&c, x->to, sizeof (c))) return 0;
+    }
+
+    while (1) {
+        x->in[at] = input;
+        if (n == 0) break;
+        at = w->steps[n].at;
+        input = w->steps[n].input;
+        n = w->steps[n].parent;
+    }
+    x->found = 1;
+    return 1;
+}
+
+/*Input of every frame of the route found*/
+static unsigned char* routeInputs(void) {
+    unsigned int n, i, steps = 0;
+    unsigned int* path;
+    unsigned char* in = calloc(goalFrame, 1);
+    Follow* w = calloc(1, sizeof (Follow));
+    Wanted x;
+
+    for (n = goalNode; n != NO_NODE; n = nodes[n].parent) steps++;
+    path = malloc(steps * sizeof (unsigned int));
+    if (path == NULL || in == NULL || w == NULL) fail("clmsolve");
+    i = steps;
+    for (n = goalNode; n != NO_NODE; n = nodes[n].parent) path[--i] = n;
+
+    for (i = 0; i < steps; i++) {
+        n = path[i];
+        x.to = i + 1 < steps ? &nodes[path[i + 1]].state : NULL;
+        x.frames = (i + 1 < steps ? nodes[path[i + 1]].frame : goalFrame) - nodes[n].frame;
+        x.in = in + nodes[n].frame;
+        x.found = 0;
+        decode(&nodes[n].state);
+        followMoves(w, endWanted, &x);
+        if (!x.found) {
+            fprintf(stderr, "clmsolve: a move of the route was not found again\n");
+            exit(1);
+        }
+    }
+    free(path);
+    free(w);
+    return in;
+}
+
+/*Play the route on the core, 1 when it picks the last diamond in its
+ *last frame
+ */
+static int checkRoute(unsigned char cave, unsigned char speed, const unsigned char* in) {
+    unsigned int f;
+
+    memset(&clm, 0, sizeof (clm));
+    clmNewGame(GAME_TYPE_NORMAL, cave, speed);
+    clmStartCave();
+    for (f = 0; f < goalFrame; f++) {
+        if (!clmStep(in[f])) break;
+    }
+    return f == goalFrame - 1 && clm.caveAllPicked;
+}
+
+/*Replay of the route found*/
+static void writeRoute(unsigned char cave, unsigned char speed, const unsigned char* in, const char* prefix) {
+    ClmReplay r;
+    ClmResult result;
+    unsigned int f;
+    char name[4096];
+
+    clmReplayInit(&r, cave == TRAINING_CAVE_INDEX ? GAME_TYPE_TRAINING : GAME_TYPE_NORMAL,
+            cave == TRAINING_CAVE_INDEX ? 0 : cave, speed);
+    for (f = 0; f < goalFrame; f++) clmReplayRecord(&r, f, in[f]);
+
+    r.length = goalFrame;
+    r.flags = CLM_REPLAY_HAS_RESULT;
+    r.hash = clmReplayPlay(&r, goalFrame, &result);
+    r.result = result;
+
+    snprintf(name, sizeof (name), "%s%02d%s.clr", prefix, cave + 1,
+            speed == GAME_SPEED_NORMAL ? "n" : "s");
+    if (clmReplaySave(&r, name)) fail(name);
+    clmReplayFree(&r);
+}
+
+/*Give the memory budget out: half to the places, kept at most 3/4 full,
+ *the rest to the fronts, the states waiting in the buckets and the route
+ *nodes of the expanded states
+ */
+static void allocate(void) {
+    size_t slots;
+
+    free(table);
+    free(places);
+    for (slots = 1024; slots * 2 * (sizeof (Slot) + placeBytes) <= budget / 2; slots *= 2);
+    table = calloc(slots, sizeof (Slot));
+    places = malloc(slots * placeBytes);
+    if (table == NULL || places == NULL) fail("clmsolve");
+    tableMask = slots - 1;
+    tableLimit = slots / 4 * 3;
+    frontLimit = budget / 4 / (2 * sizeof (Front));
+    entryLimit = budget / 8 / (2 * sizeof (Entry));
+    if (nodes == NULL) {
+        nodeCapacity = budget / 8 / sizeof (Node);
+        nodes = malloc(nodeCapacity * sizeof (Node));
+        if (nodes == NULL) fail("clmsolve");
+    }
+}
+
+/*Solve one cave at one speed*/
+static void solve(unsigned char cave, unsigned char speed, const char* prefix, int verbose) {
+    Entry first;
+    pthread_t pool[MAX_THREADS];
+    struct timespec t0, t1;
+    unsigned char* in = NULL;
+    double seconds;
+    size_t i;
+    int t, b;
+
+    clmHostInit();
+    loadCave(cave, speed);
+
+    if (table) {
+        for (i = 0; i <= tableMask; i++) free(table[i].front);
+    }
+    allocate();
+    tableUsed = 0;
+    frontUsed = 0;
+    entriesUsed = 0;
+    nodeCount = 0;
+    overflow = 0;
+    truncated = 0;
+    pruned = 0;
+    statesExpanded = 0;
+    mostCollected = 0;
+    goalFrame = 0xFFFFFFFFU;
+    for (b = 0; b < BUCKETS; b++) {
+        for (t = 0; t < threads; t++) lists[b][t].count = 0;
+    }
+
+    clm = start;
+    settle();
+    encode(&first.state);
+    checkEncoded(&first.state);
+    first.parent = NO_NODE;
+    frame = 0;
+    visit(&first.state, 0);
+    push(&lists[0][0], &first);
+
+    clock_gettime(CLOCK_MONOTONIC, &t0);
+    finished = 0;
+    for (t = 0; t < threads; t++) {
+        if (pthread_create(&pool[t], NULL, worker, (void*) (long) t)) fail("pthread_create");
+    }
+
+    while (1) {
+        if (overflow || !nextBucket()) finished = 1;
+        bucketNext = 0;
+        pthread_barrier_wait(&barrier);
+        if (finished) break;
+        pthread_barrier_wait(&barrier);
+        entriesUsed -= bucketTotal;
+        for (t = 0; t < threads; t++) lists[frame % BUCKETS][t].count = 0;
+        if (verbose && frame % 100 == 0) {
+            fprintf(stderr, "  frame %u, %zu states, %llu expanded, %u of %u diamonds\n",
+                    frame, frontUsed, statesExpanded, mostCollected, diamondCount);
+        }
+        frame++;
+    }
+    for (t = 0; t < threads; t++) pthread_join(pool[t], NULL);
+    clock_gettime(CLOCK_MONOTONIC, &t1);
+    seconds = (t1.tv_sec - t0.tv_sec) + (t1.tv_nsec - t0.tv_nsec) / 1e9;
+
+    if (goalFrame != 0xFFFFFFFFU) {
+        in = routeInputs();
+        if (!checkRoute(cave, speed, in)) {
+            fprintf(stderr, "cave %d: the route found does not complete the cave\n", cave + 1);
+            exit(1);
+        }
+    }
+
+    printf("cave %2d %s: ", cave + 1, speed == GAME_SPEED_NORMAL ? "normal" : "slow  ");
+    if (goalFrame != 0xFFFFFFFFU) {
+        printf("%s route %u frames (%.1f s of play)",
+                overflow || truncated || pruned || relax ? "a" : "shortest", goalFrame, goalFrame / 60.0);
+    } else if (overflow || truncated || pruned || relax) {
+        printf("no route found");
+    } else {
+        printf("impossible, no route completes the cave");
+    }
+
+    /*Why neither a shortest route nor a missing one is proven*/
+    if (overflow) printf(", state budget exhausted at frame %u", frame);
+    if (truncated) printf(", moves too long to follow");
+    if (pruned) printf(", beam pruned");
+    if (relax) printf(", broken rocks relaxed");
+    printf(", %llu states expanded, %zu stored, %.2f s\n", statesExpanded, frontUsed, seconds);
+    fflush(stdout);
+
+    if (prefix && in) writeRoute(cave, speed, in, prefix);
+    free(in);
+}
+
+static void usage(void) {
+    fprintf(stderr, "usage: clmsolve [-c cave] [-s speed] [-j threads] [-m megabytes] [-w prefix] [-r relax] [-b beam] [-v]\n"
+            "  -c cave       cave 1-%d, %d is the training cave (default: all)\n"
+            "  -s speed      0 normal, 1 slow (default: both)\n"
+            "  -j threads    worker threads (default: all cores)\n"
+            "  -m megabytes  memory for visited states and routes (default 1024)\n"
+            "  -w prefix     write the routes as replays, prefix01n.clr ...\n"
+            "  -r relax      heuristic, broken rocks told apart by 0 timer (exact),\n"
+            "                1 stage, 2 half, 3 gone or not (default 0)\n"
+            "  -b beam       heuristic, expand at most this many states per frame,\n"
+            "                those with the most diamonds and nearest to the next\n"
+            "                (default 200, 0 all)\n"
+            "  -v            progress on stderr\n", TRAINING_CAVE_INDEX + 1, TRAINING_CAVE_INDEX + 1);
+    exit(2);
+}
+
+int main(int argc, char** argv) {
+    int cave = -1, speed = -1, verbose = 0;
+    long megabytes = 1024;
+    const char* prefix = NULL;
+    int opt, c, s;
+
+    threads = (int) sysconf(_SC_NPROCESSORS_ONLN);
+
+    while ((opt = getopt(argc, argv, "c:s:j:m:w:r:b:v")) != -1) {
+        switch (opt) {
+            case 'c':
+                cave = atoi(optarg) - 1;
+                if (cave < 0 || cave > TRAINING_CAVE_INDEX) usage();
+                break;
+            case 's':
+                speed = atoi(optarg);
+                if (speed != GAME_SPEED_NORMAL && speed != GAME_SPEED_SLOW) usage();
+                break;
+            case 'j':
+                threads = atoi(optarg);
+                break;
+            case 'm':
+                megabytes = atol(optarg);
+                break;
+            case 'w':
+                prefix = optarg;
+                break;
+            case 'b':
+                beam = (size_t) atol(optarg);
+                break;
+            case 'r':
+                relax = atoi(optarg);
+                if (relax < 0 || relax > 3) usage();
+                break;
+            case 'v':
+                verbose = 1;
+                break;
+            default:
+                usage();
+        }
+    }
+    brokenMask = relaxMasks[relax];
+    if (threads < 1) threads = 1;
+    if (threads > MAX_THREADS) threads = MAX_THREADS;
+
+    budget = (size_t) megabytes * 1024 * 1024;
+    for (c = 0; c < LOCKS; c++) pthread_mutex_init(&locks[c], NULL);
+    if (pthread_barrier_init(&barrier, NULL, threads + 1)) fail("pthread_barrier_init");
+
+    for (c = 0; c <= TRAINING_CAVE_INDEX; c++) {
+        if (cave >= 0 && c != cave) continue;
+        for (s = GAME_SPEED_NORMAL; s <= GAME_SPEED_SLOW; s++) {
+            if (speed >= 0 && s != speed) continue;
+            solve(c, s, prefix, verbose);
+        }
+    }
+    return 0;
+}
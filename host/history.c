@@ -0,0 +1,155 @@
+/* Curse of the lost miner - snapshots and frame history of the core.
+ * See history.h.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "history.h"
+
+/*Equal bytes that do not end a run, a new run costs at least as much*/
+#define RUN_GAP (2)
+
+/*Most a frame can take in the data: every other byte a run of its own*/
+#define FRAME_MAX (3 * CLM_SNAPSHOT_SIZE + 16)
+
+void clmSnapshotSave(unsigned char* snapshot) {
+    memcpy(snapshot, &clm, CLM_SNAPSHOT_SIZE);
+}
+
+void clmSnapshotLoad(const unsigned char* snapshot) {
+    memcpy(&clm, snapshot, CLM_SNAPSHOT_SIZE);
+    paintCave();
+    updateStatusBar();
+}
+
+void clmHistoryInit(ClmHistory* h, unsigned long interval) {
+    memset(h, 0, sizeof (*h));
+    h->interval = interval ? interval : CLM_HISTORY_INTERVAL;
+}
+
+void clmHistoryFree(ClmHistory* h) {
+    free(h->data);
+    free(h->keys);
+    h->data = NULL;
+    h->keys = NULL;
+    h->frames = h->used = h->capacity = h->keyCapacity = 0;
+}
+
+static void* grow(void* p, unsigned long* capacity, unsigned long need, unsigned long size) {
+    unsigned long c = *capacity ? *capacity : 1024;
+
+    if (need <= *capacity) return p;
+    while (c < need) c *= 2;
+    p = realloc(p, c * size);
+    if (p == NULL) {
+        perror("clmHistoryRecord");
+        exit(1);
+    }
+    *capacity = c;
+    return p;
+}
+
+static void putVarint(ClmHistory* h, unsigned long v) {
+    while (v >= 0x80) {
+        h->data[h->used++] = (unsigned char) ((v & 0x7F) | 0x80);
+        v >>= 7;
+    }
+    h->data[h->used++] = (unsigned char) v;
+}
+
+static unsigned long getVarint(const unsigned char** p) {
+    unsigned long v = 0;
+    unsigned shift = 0;
+
+    while (**p & 0x80) {
+        v |= (unsigned long) (*(*p)++ & 0x7F) << shift;
+        shift += 7;
+    }
+    return v | (unsigned long) *(*p)++ << shift;
+}
+
+/*Next run of changed bytes from at, 0 when there is none*/
+static int nextRun(const unsigned char* was, const unsigned char* is, unsigned long at,
+        unsigned long* start, unsigned long* end) {
+    unsigned long i, same;
+
+    while (at < CLM_SNAPSHOT_SIZE && was[at] == is[at]) at++;
+    if (at == CLM_SNAPSHOT_SIZE) return 0;
+
+    *start = at;
+    *end = at + 1;
+    for (i = *end, same = 0; i < CLM_SNAPSHOT_SIZE && same <= RUN_GAP; i++) {
+        if (was[i] == is[i]) {
+            same++;
+        } else {
+            same = 0;
+            *end = i + 1;
+        }
+    }
+    return 1;
+}
+
+void clmHistoryRecord(ClmHistory* h) {
+    const unsigned char* is = (const unsigned char*) &clm;
+    unsigned long start, end, at, count;
+
+    h->data = grow(h->data, &h->capacity, h->used + FRAME_MAX, 1);
+
+    if (h->frames % h->interval == 0) {
+        h->keys = grow(h->keys, &h->keyCapacity, h->frames / h->interval + 1, sizeof (*h->keys));
+        h->keys[h->frames / h->interval] = h->used;
+        memcpy(h->data + h->used, is, CLM_SNAPSHOT_SIZE);
+        h->used += CLM_SNAPSHOT_SIZE;
+    } else {
+        for (at = 0, count = 0; nextRun(h->last, is, at, &start, &end); at = end) count++;
+        putVarint(h, count);
+        for (at = 0; nextRun(h->last, is, at, &start, &end); at = end) {
+            putVarint(h, start - at);
+            putVarint(h, end - start);
+            memcpy(h->data + h->used, is + start, end - start);
+            h->used += end - start;
+        }
+    }
+
+    memcpy(h->last, is, CLM_SNAPSHOT_SIZE);
+    h->frames++;
+}
+
+int clmHistorySeek(const ClmHistory* h, unsigned long frame) {
+    unsigned char* state = (unsigned char*) &clm;
+    const unsigned char* p;
+    unsigned long f, count, at, length;
+
+    if (frame >= h->frames) return -1;
+
+    p = h->data + h->keys[frame / h->interval];
+    memcpy(state, p, CLM_SNAPSHOT_SIZE);
+    p += CLM_SNAPSHOT_SIZE;
+
+    for (f = frame % h->interval; f > 0; f--) {
+        for (count = getVarint(&p), at = 0; count > 0; count--) {
+            at += getVarint(&p);
+            length = getVarint(&p);
+            memcpy(state + at, p, length);
+            p += length;
+            at += length;
+        }
+    }
+
+    paintCave();
+    updateStatusBar();
+    return 0;
+}
+
+unsigned long clmHistoryBytes(const ClmHistory* h) {
+    return h->used + (h->frames + h->interval - 1) / h->interval * sizeof (*h->keys);
+}
+
+unsigned char clmHistoryRecordInput(unsigned long frame, void* ctx) {
+    ClmHistoryRecorder* rec = ctx;
+
+    clmHistoryRecord(rec->history);
+    return rec->source(frame, rec->ctx);
+}
@@ -0,0 +1,68 @@
+/* Curse of the lost miner - snapshots and frame history of the core.
+ *
+ * A snapshot is the whole ClmState as bytes, CLM_SNAPSHOT_SIZE of them;
+ * everything the core carries from one frame to the next lives there.
+ * Loading one repaints the cave screen and the status bar from it.
+ * Snapshots are only meant for the build that saved them.
+ *
+ * A history holds the state at the start of every frame of a game. Every
+ * interval-th frame is kept as a snapshot (a keyframe), the frames in
+ * between as the bytes that changed since the frame before; most frames
+ * change a few bytes of the cave arrays or none. Seeking loads the
+ * keyframe at or before the frame and applies at most interval - 1
+ * deltas. In the data, all numbers are unsigned LEB128 varints:
+ *
+ *   keyframe  CLM_SNAPSHOT_SIZE bytes
+ *   delta     count, count * (bytes kept since the last run, length,
+ *             length bytes)
+ */
+
+#ifndef HISTORY_H
+#define HISTORY_H
+
+#include "clmhost.h"
+
+#define CLM_SNAPSHOT_SIZE (sizeof (ClmState))
+#define CLM_HISTORY_INTERVAL (256)
+
+typedef struct {
+    unsigned long interval;
+    unsigned long frames; /*Frames recorded*/
+
+    unsigned char* data;
+    unsigned long used;
+    unsigned long capacity;
+
+    unsigned long* keys; /*Where each keyframe starts in data*/
+    unsigned long keyCapacity;
+
+    unsigned char last[CLM_SNAPSHOT_SIZE]; /*State of the last frame recorded*/
+} ClmHistory;
+
+/*Recording wrapper around another input source*/
+typedef struct {
+    ClmInputFunc source;
+    void* ctx;
+    ClmHistory* history;
+} ClmHistoryRecorder;
+
+void clmSnapshotSave(unsigned char* snapshot);
+void clmSnapshotLoad(const unsigned char* snapshot);
+
+/*Interval 0 takes CLM_HISTORY_INTERVAL*/
+void clmHistoryInit(ClmHistory* h, unsigned long interval);
+void clmHistoryFree(ClmHistory* h);
+
+/*Append the state of this thread as the next frame*/
+void clmHistoryRecord(ClmHistory* h);
+
+/*Load the state at the start of a frame, -1 if it was not recorded*/
+int clmHistorySeek(const ClmHistory* h, unsigned long frame);
+
+/*Bytes held, the keyframe table included*/
+unsigned long clmHistoryBytes(const ClmHistory* h);
+
+/*ClmInputFunc, ctx is a recorder. Records the frame before its input*/
+unsigned char clmHistoryRecordInput(unsigned long frame, void* ctx);
+
+#endif
@@ -0,0 +1,214 @@
+/* Curse of the lost miner - input recordings.
+ * See replay.h.
+ */
+
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "replay.h"
+
+static const unsigned char magic[4] = {'C', 'L', 'M', 'R'};
+
+void clmReplayInit(ClmReplay* r, unsigned char type, unsigned char cave, unsigned char speed) {
+    memset(r, 0, sizeof (*r));
+    r->gameType = type;
+    r->startCave = cave;
+    r->gameSpeed = speed;
+}
+
+void clmReplayFree(ClmReplay* r) {
+    free(r->events);
+    r->events = NULL;
+    r->count = r->capacity = 0;
+}
+
+static int append(ClmReplay* r, unsigned long frame, unsigned char input) {
+    ClmReplayEvent* e;
+
+    if (r->count == r->capacity) {
+        r->capacity = r->capacity ? r->capacity * 2 : 64;
+        e = realloc(r->events, r->capacity * sizeof (*e));
+        if (e == NULL) return -1;
+        r->events = e;
+    }
+    r->events[r->count].frame = frame;
+    r->events[r->count].input = input;
+    r->count++;
+    return 0;
+}
+
+void clmReplayRecord(ClmReplay* r, unsigned long frame, unsigned char input) {
+    unsigned char last = r->count ? r->events[r->count - 1].input : JS_LOG_CENTER;
+
+    if (input == last) return;
+    if (append(r, frame, input)) {
+        perror("clmReplayRecord");
+        exit(1);
+    }
+}
+
+/*Varints*/
+static void putVarint(FILE* f, unsigned long long v) {
+    while (v >= 0x80) {
+        fputc((int) (v & 0x7F) | 0x80, f);
+        v >>= 7;
+    }
+    fputc((int) v, f);
+}
+
+static int getVarint(const unsigned char** p, const unsigned char* end, unsigned long long* v) {
+    unsigned shift = 0;
+
+    *v = 0;
+    while (*p < end && shift < 64) {
+        *v |= (unsigned long long) (**p & 0x7F) << shift;
+        if ((*(*p)++ & 0x80) == 0) return 0;
+        shift += 7;
+    }
+    return -1;
+}
+
+int clmReplaySave(const ClmReplay* r, const char* path) {
+    FILE* f = fopen(path, "wb");
+    unsigned long i, last = 0;
+    int b;
+
+    if (f == NULL) return -1;
+
+    fwrite(magic, 1, sizeof (magic), f);
+    fputc(CLM_REPLAY_VERSION, f);
+    fputc(r->gameType, f);
+    fputc(r->startCave, f);
+    fputc(r->gameSpeed, f);
+    fputc(r->flags, f);
+
+    putVarint(f, r->count);
+    for (i = 0; i < r->count; i++) {
+        putVarint(f, r->events[i].frame - last);
+        fputc(r->events[i].input, f);
+        last = r->events[i].frame;
+    }
+    putVarint(f, r->length);
+
+    if (r->flags & CLM_REPLAY_HAS_RESULT) {
+        fputc(r->result.gameOverType, f);
+        fputc(r->result.caveReached, f);
+        fputc(r->result.lives, f);
+        putVarint(f, r->result.frames);
+        for (b = 0; b < 8; b++) fputc((int) (r->hash >> (b * 8)) & 0xFF, f);
+    }
+
+    if (ferror(f)) {
+        fclose(f);
+        errno = EIO;
+        return -1;
+    }
+    return fclose(f);
+}
+
+int clmReplayLoad(ClmReplay* r, const char* path) {
+    FILE* f = fopen(path, "rb");
+    unsigned char* data;
+    const unsigned char* p;
+    const unsigned char* end;
+    unsigned long long v, count, frame = 0;
+    long size;
+    int b;
+
+    memset(r, 0, sizeof (*r));
+    if (f == NULL) return -1;
+
+    /*Recordings are small, read the whole file*/
+    if (fseek(f, 0, SEEK_END) || (size = ftell(f)) < 0 || fseek(f, 0, SEEK_SET)) {
+        fclose(f);
+        return -1;
+    }
+    data = malloc(size ? size : 1);
+    if (data == NULL || fread(data, 1, size, f) != (size_t) size) {
+        free(data);
+        fclose(f);
+        errno = EIO;
+        return -1;
+    }
+    fclose(f);
+
+    p = data;
+    end = data + size;
+    if (size < 9 || memcmp(p, magic, sizeof (magic)) || p[4] != CLM_REPLAY_VERSION) goto bad;
+    r->gameType = p[5];
+    r->startCave = p[6];
+    r->gameSpeed = p[7];
+    r->flags = p[8];
+    p += 9;
+
+    /*The core looks the cave up without a check. The training game
+     *always plays the training cave
+     */
+    if (r->gameType != GAME_TYPE_NORMAL && r->gameType != GAME_TYPE_TRAINING) goto bad;
+    if (r->gameSpeed != GAME_SPEED_NORMAL && r->gameSpeed != GAME_SPEED_SLOW) goto bad;
+    if (r->gameType == GAME_TYPE_NORMAL ? r->startCave > MAX_CAVE_INDEX
+            : r->startCave > TRAINING_CAVE_INDEX) goto bad;
+
+    if (getVarint(&p, end, &count)) goto bad;
+    while (count--) {
+        if (getVarint(&p, end, &v) || p >= end) goto bad;
+        frame += v;
+        if (append(r, frame, *p++)) goto bad;
+    }
+    if (getVarint(&p, end, &v)) goto bad;
+    r->length = v;
+
+    if (r->flags & CLM_REPLAY_HAS_RESULT) {
+        if (end - p < 3) goto bad;
+        r->result.gameOverType = *p++;
+        r->result.caveReached = *p++;
+        r->result.lives = *p++;
+        if (getVarint(&p, end, &v) || end - p < 8) goto bad;
+        r->result.frames = v;
+        for (b = 0; b < 8; b++) r->hash |= (unsigned long long) *p++ << (b * 8);
+    }
+
+    free(data);
+    return 0;
+
+bad:
+    free(data);
+    clmReplayFree(r);
+    errno = EINVAL;
+    return -1;
+}
+
+void clmReplayRewind(ClmReplayCursor* c, const ClmReplay* r) {
+    c->replay = r;
+    c->next = 0;
+    c->input = JS_LOG_CENTER;
+}
+
+unsigned char clmReplayInput(unsigned long frame, void* ctx) {
+    ClmReplayCursor* c = ctx;
+    const ClmReplay* r = c->replay;
+
+    while (c->next < r->count && r->events[c->next].frame <= frame) {
+        c->input = r->events[c->next++].input;
+    }
+    return c->input;
+}
+
+unsigned char clmReplayRecordInput(unsigned long frame, void* ctx) {
+    ClmReplayRecorder* rec = ctx;
+    unsigned char input = rec->source(frame, rec->ctx);
+
+    clmReplayRecord(rec->replay, frame, input);
+    return input;
+}
+
+unsigned long long clmReplayPlay(const ClmReplay* r, unsigned long maxFrames, ClmResult* result) {
+    ClmReplayCursor c;
+
+    clmReplayRewind(&c, r);
+    if (r->length != 0 && r->length < maxFrames) maxFrames = r->length;
+    clmHostPlay(r->gameType, r->startCave, r->gameSpeed, clmReplayInput, &c, maxFrames, result);
+    return clmHostHash();
+}
@@ -0,0 +1,80 @@
+/* Curse of the lost miner - input recordings.
+ *
+ * A replay is the starting cave, game type and speed plus the list of
+ * frames at which the logical input byte changed. The core is fully
+ * deterministic, so that is all it takes to reproduce a game. A replay
+ * may also carry the outcome it produced when recorded.
+ *
+ * File format, all multi-byte numbers are unsigned LEB128 varints:
+ *   "CLMR" version type cave speed flags
+ *   count, count * (frame delta, input byte), length in frames (0 = open)
+ *   if flags & CLM_REPLAY_HAS_RESULT:
+ *     gameOverType caveReached lives, frames, 8 byte state hash (LE)
+ */
+
+#ifndef REPLAY_H
+#define REPLAY_H
+
+#include "clmhost.h"
+
+#define CLM_REPLAY_VERSION (1)
+#define CLM_REPLAY_HAS_RESULT (1)
+
+typedef struct {
+    unsigned long frame;
+    unsigned char input;
+} ClmReplayEvent;
+
+typedef struct {
+    unsigned char gameType;
+    unsigned char startCave;
+    unsigned char gameSpeed;
+    unsigned char flags;
+
+    unsigned long count;
+    unsigned long capacity;
+    ClmReplayEvent* events;
+
+    /*Frames recorded, playback stops there*/
+    unsigned long length;
+
+    /*Expected outcome*/
+    ClmResult result;
+    unsigned long long hash;
+} ClmReplay;
+
+/*Playback position in a replay*/
+typedef struct {
+    const ClmReplay* replay;
+    unsigned long next;
+    unsigned char input;
+} ClmReplayCursor;
+
+/*Recording wrapper around another input source*/
+typedef struct {
+    ClmInputFunc source;
+    void* ctx;
+    ClmReplay* replay;
+} ClmReplayRecorder;
+
+void clmReplayInit(ClmReplay* r, unsigned char type, unsigned char cave, unsigned char speed);
+void clmReplayFree(ClmReplay* r);
+
+/*Return 0 on success, -1 with errno set otherwise. A game type, speed or
+ *starting cave the core does not know is EINVAL
+ */
+int clmReplayLoad(ClmReplay* r, const char* path);
+int clmReplaySave(const ClmReplay* r, const char* path);
+
+/*Append the input of a frame, kept only when it differs from the last one*/
+void clmReplayRecord(ClmReplay* r, unsigned long frame, unsigned char input);
+
+/*ClmInputFunc implementations, ctx is a cursor or a recorder*/
+void clmReplayRewind(ClmReplayCursor* c, const ClmReplay* r);
+unsigned char clmReplayInput(unsigned long frame, void* ctx);
+unsigned char clmReplayRecordInput(unsigned long frame, void* ctx);
+
+/*Play the replay on this thread, fills result and returns the state hash*/
+unsigned long long clmReplayPlay(const ClmReplay* r, unsigned long maxFrames, ClmResult* result);
+
+#endif
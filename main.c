@@ -39,136 +39,124 @@
  * PMG one-line resolution (2k)                  : 4096 - 6143 PAGE:16 OFFSET:  0
  * Cave display memory (22x40=880 bytes)         : 6144 - 7023 PAGE:24 OFFSET:  0
  * Cave status bar (40 bytes)                    : 7024 - 7083 PAGE:27 OFFSET:112
- * Menu display memory(960 bytes)                : 15872 -16352 
+ * Second cave display memory and status bar      : 8192 - 9111 PAGE:32 OFFSET:  0
+ * Cave display lists (2x36 bytes)               : 9120 - 9155, 9160 - 9195
+ * Animated cave font, frames 1-3 (3x1024 bytes) : 9216 -12287 PAGE:36
+ * Second animated cave font, for the second cave : 12288-15359 PAGE:48
+ * display memory
+ * C stack (1024 bytes)                          : 15360-16383
+ * Changing menu rows (2x20 bytes)               : 6144 - 6183, in the cave
+ *                                                 display memory
  * 
  * Read/Write sound effects and music
  * ----------------------------------
- * All relocated from cartridge ROM
- * Raster Music Tracker Aux1                     : 7554
- * Raster Music Tracker Aux2                     : 7680
- * Raster Music Tracker Main                     : 7936, Entry point 8192 
- * RMT File                                      : 9216 (0x2400)
+ * The player and the music run from cartridge ROM
+ * Raster Music Tracker variables (109 bytes)    : 7392 - 7500
+ * Raster Music Tracker zero page                : 235 - 252
+ * Paint queue pointer of the VBI                : 253 - 254
  */
 
 #pragma codesize(100)
 
+/*Frame time meter in the status bar, toggled with keypad #. Set
+ *CLM_METER in rmt_sup.s as well, it times the VBI and the DLIs
+ */
+//#define CLM_METER
+
+//#link "clmcore.c"
 //#link "rmt_sup.s"
 //#link "data.s"
+//#link "screens.s"
+//#link "rmt_player.s"
 //#resource "clmfont1.fnt"
 //#resource "clmfont2.fnt"
-//#resource "rmt_aux1.bin"
-//#resource "rmt_aux2.bin"
-//#resource "levels.dat"
-//#resource "rmt_main.bin"
-//#resource "rmt_music.bin"
+//#resource "rmt_volume.bin"
+//#resource "rmt_freq.bin"
+//#resource "levels.pak"
+//#resource "rmt_music.s"
+//#resource "fontanim.s"
 
 /*Memory layout constants*/
 #define MA_CAVDMEM 6144U
+#define MA_CAVDMEM2 8192U
 #define MA_PMGPAGE 16U
 #define MA_PMGSTART 4096U
 #define MA_PMGEND 6143U
-#define MA_SBMEM 7024U
-#define MA_RMT_AUX1 7554U
-#define MA_RMT_AUX2 7680U
-#define MA_RMT_MAIN 7936U
-#define MA_RMT_MUSIC 9216U
+#define MA_ANIMFONT 9216U
+#define MA_ANIMFONT2 12288U
+#define MA_CAVEDL 9120U /*CAVE_DL of data.s*/
+#define MA_CAVEDL2 9160U /*CAVE_DL2 of data.s*/
+#define MA_MENUROWS 6144U /*MENU_ROWS of screens.s*/
 
 extern unsigned char CLM_DATA_CHSET1;
 extern unsigned char CLM_DATA_CHSET2;
-extern unsigned char CLM_DATA_CAVES;
 extern unsigned char CLM_DATA_DL_CAVE;
-extern unsigned char CLM_RMT_AUX1;
-extern unsigned char CLM_RMT_AUX2;
-extern unsigned char CLM_RMT_MAIN;
-extern unsigned char CLM_RMT_MUSIC;
-extern unsigned char CLM_RMT_MUSIC_END;
-
-
-/*Caves*/
-#define MAX_CAVE_INDEX (12)
-#define NUMBER_OF_CAVES (13)
-#define TRAINING_CAVE_INDEX (13)
-#define CAVESIZE (222)
-
-/*Control speed*/
-#define CTRL_DELAY (5)
+extern unsigned char CLM_DATA_DL_CAVE2;
+extern unsigned char* const CLM_DATA_LOOKS[]; /*Of each cave, see data.s*/
 
+/*Animated tiles - characters and their glyphs in frames 1-3, fontanim.s*/
+extern unsigned char CLM_ANIM_CHARS[];
+extern unsigned char CLM_ANIM_CHSET1[];
+extern unsigned char CLM_ANIM_CHSET2[];
 
-/*Control threshold*/
-#define JS_LEFT (76)
-#define JS_RIGHT (152)
-#define JS_UP (76)
-#define JS_DOWN (152)
 
 /*Keypad*/
 #define KPAD_NONE (0xFF)
 #define KPAD_0    (0x00)
 #define KPAD_ASTERISK (0x0A)
+#define KPAD_HASH (0x0B)
 #define KPAD_PAUSE (0x0D)
 #define KPAD_RESET (0x0E)
+#define KEY_QUEUE_SIZE (8)
+#define KEY_RELEASED (0x80) /*Added to a key when it is let go*/
 
-/*Logical joystick position*/
-#define JS_LOG_CENTER (0)
-#define JS_LOG_LEFT (1)
-#define JS_LOG_RIGHT (2)
-#define JS_LOG_UP (4)
-#define JS_LOG_DOWN (8)
-
-#define JS_LOG_UP_LEFT  (5)
-#define JS_LOG_UP_RIGHT (6)
-
-#define POT_HORIZONTAL (0x11)
-#define POT_VERTICAL (0x12)
-
-/*Movement when miner is falling*/
-#define FALL_FLAG_NONE (0)
-#define FALL_FLAG_LEFT (1)
-#define FALL_FLAG_RIGHT (2)
-#define FALL_FLAG_LEFT_AND_RIGHT (3)
-#define FALL_FLAG_FALLING (4)
-
-/*Game over type*/
-#define GAME_OVER_NONE  (0)
-#define GAME_OVER_DEATH  (1)
-#define GAME_OVER_SUCCESS  (2)
-#define GAME_OVER_USER_QUIT (3)
+/*Menu - frames a direction is held before it repeats*/
+#define MENU_REPEAT (15)
 
-/*Game type*/
-#define GAME_TYPE_NORMAL (0)
-#define GAME_TYPE_TRAINING (1)
+/*Text screens, prebuilt in screens.s*/
+#define SC_DIGITS (16) /*Screen code of 0*/
+#define MENU_COLUMN (15) /*Column of the starting cave and the game speed*/
 
-/*Game speed*/
-#define GAME_SPEED_NORMAL (0)
-#define GAME_SPEED_SLOW (1)
+extern unsigned char CLM_TEXT_DL_BLANK;
+extern unsigned char CLM_TEXT_DL_MENU;
+extern unsigned char CLM_TEXT_DL_TRAINING;
+extern unsigned char CLM_TEXT_DL_GAME_OVER;
+extern unsigned char CLM_TEXT_DL_CONGRATULATIONS;
+extern unsigned char CLM_TEXT_DL_RETURN;
+extern unsigned char CLM_TEXT_MENU_ROWS[];
+extern unsigned char CLM_TEXT_NORM[];
+extern unsigned char CLM_TEXT_SLOW[];
 
 
-#include <stdio.h>
-#include <conio.h>
 #include <peekpoke.h>
 #include <stdlib.h>
 #include <string.h>
 #include <atari5200.h>
 #include <6502.h>
 
+#include "clmcore.h"
+
 
 /*Main game routine*/
 void doGame(void);
-void relocateRmt(void);
-
 
-/*Caves and cave elements*/
-void paintElement(unsigned char x, unsigned char y, unsigned char elem);
-void paintCave(void);
-void rebuildCaveElementArray(unsigned char cv);
 
 /*Miner - PMG*/
 void pmgInit(void);
 void setMinerPos(unsigned char x, unsigned char y);
-void repaintMiner(void);
+void glideMiner(unsigned char x, unsigned char y);
+
+/*Animated tiles*/
+unsigned char buildAnimStep(void);
+
+/*Next cave, made ready in the spare time of the frames*/
+void prepareCave(unsigned char cv, unsigned char buffer);
+unsigned char prepareStep(void);
+void prepareIdle(void);
 
 /*Time and timing*/
 void delay(unsigned int w);
-void adjustGameSpeed(unsigned char speed);
+unsigned char waitFrame(void);
 
 
 /*Text mode displays*/
@@ -178,10 +166,13 @@ void displayReturnToMenuScreen(void);
 void setTextModeSettings(void);
 void displayMainMenu(void);
 void displayTrainingText(void);
+void showTextScreen(unsigned char* dl);
+void showHiddenText(void);
 
 /*Display game speed and starting cave*/
 void displayGameSpeed(void);
 void displayStartingCave(void);
+void writeNumber2(unsigned char* s, unsigned char n);
 
 /*SFX and music routines*/
 void rmtInitMenuMusic(void);
@@ -203,17 +194,29 @@ void rmtRestoreVBI(void);
 /*Reboot*/
 void asmReboot();
 
-/*Miner movement*/
-unsigned char moveLeft(void);
-unsigned char moveRight(void);
-void moveUp(void);
-void moveDown(void);
-unsigned char jumpUp(void); /*Return 0 if OK, 1 if death*/
-void fallDown(void);
-void handleHighJump(void);
-void updateStatusBar(void);
-unsigned char checkTreasure(void);
-void checkDeath(void);
+/*Frame time meter*/
+#ifdef CLM_METER
+void meterFrame(void);
+void meterShow(void);
+void meterNumber(unsigned char* s, unsigned int n);
+#endif
+
+/*Joystick, sampled by the VBI*/
+unsigned char joyTakePressed(void);
+unsigned char joyTakeReleased(void);
+unsigned char menuControls(void);
+void waitFire(void);
+
+/*Keypad events, queued by the keypad interrupt and the VBI*/
+unsigned char keyTake(void);
+
+/*Game loop adapter*/
+unsigned char readControls(void);
+void syncMiner(void);
+void setCaveDl(void);
+void setDliEntries(void);
+void setCaveLook(void);
+void showCave(void);
 
 /*Pause*/
 void handlePause(void);
@@ -221,157 +224,146 @@ void handlePause(void);
 unsigned char maxCaveReached; /*Max. warp*/
 unsigned char startingCave; /*Warp*/
 unsigned char dmactlStore; /*DMA CTL shadow Store*/
-unsigned char lives; /*Lives*/
-
-unsigned char currentCave; /*Current cave*/
-unsigned char diamondsInCave; /*How many diamonds in cave*/
-unsigned char diamondsCollected; /*How many diamonds collected*/
-unsigned char caveDeath; /*1 for death*/
-unsigned char caveAllPicked; /*1 for all picked*/
-unsigned char stayHere; /*Stay in cave*/
+
 unsigned char gameOverType;
 unsigned char gameSpeed; /*Game speed*/
 unsigned char gameType; /*Game type, normal or training*/
 
-/*Menu displaylist adress*/
-unsigned char menuDl1;
-unsigned char menuDl2;
+/*Cave display memory, the status bar follows each. A cave is painted
+ *into the one not shown and shown from a VBI
+ */
+unsigned char* const caveScreens[2] = {(unsigned char*) MA_CAVDMEM, (unsigned char*) MA_CAVDMEM2};
+unsigned char* const caveDls[2] = {(unsigned char*) MA_CAVEDL, (unsigned char*) MA_CAVEDL2};
+unsigned char* const caveDlTemplates[2] = {&CLM_DATA_DL_CAVE, &CLM_DATA_DL_CAVE2};
+#define CAVE_DL_SIZE (36)
+unsigned char caveBuffer; /*Of the cave shown or being painted*/
+#define STATUS_BAR (clmScreen + CAVE_HEIGHT * 40)
 
 /*Temporary variables for general use*/
 unsigned char x1;
 unsigned char y1;
-unsigned int i1;
-unsigned int i2;
-unsigned char z1;
 
-/*Current cave status*/
-unsigned char caveElements[20][22];
-unsigned char caveBroken [20][22];
-
-/*Miner location*/
-unsigned char minerX, minerY;
-int p0x, p0y;
+/*Miner location given to the sprite*/
+unsigned char minerShownX, minerShownY;
 
 /*Miner - PMG P0. Normal miner and jumping miner*/
-const unsigned char minerDataNormal[] = {60, 126, 90, 219, 255, 195, 102, 60};
-const unsigned char minerDataJump[] = {60, 126, 90, 219, 255, 195, 126, 0};
+#define MINER_NORMAL (0)
+#define MINER_JUMP (1)
+const unsigned char minerImages[] = {
+    60, 126, 90, 219, 255, 195, 102, 60,
+    60, 126, 90, 219, 255, 195, 126, 0
+};
 
-/*"Training" and "PAUSED" literals*/
-const unsigned char trainingLiteral[] = {52, 50, 33, 41, 46, 41, 46, 39};
-const unsigned char pausedLiteral[] = {48, 33, 53, 51, 37, 36};
+/*Miner sprite - the VBI moves player 0 to the target a few pixels a frame*/
+extern unsigned char minerTargetX; /*HPOSP0*/
+extern unsigned char minerTargetY; /*Top row of player 0*/
+extern unsigned char minerFrame; /*MINER_NORMAL or MINER_JUMP*/
+extern unsigned char minerSnap; /*Not 0 - move at once*/
 
-/*High jump*/
-unsigned char hijs;
-unsigned char hiJump;
+/*"PAUSED" literal*/
+const unsigned char pausedLiteral[] = {48, 33, 53, 51, 37, 36};
 
-/*Movement control - allocated in asm source*/
-extern unsigned char mvDelay;
+/*DLI - allocated in asm source*/
 extern unsigned char dliHandler;
 
-/*Colors changed in DLI*/
-extern unsigned char colorStore1;
-extern unsigned char colorStore2;
-
-/*Keypad*/
-extern unsigned char keypadCont;
-extern unsigned char keypadKey;
-extern unsigned char keypadDisable;
-
-extern unsigned char secondFire;
-extern unsigned char breakHandler;
-
-/*Pointer to current 'look and feel' of the miner*/
-const unsigned char* minerData = minerDataNormal;
-
-/*Movement speed setup. The higher the number, the slower the movement*/
-unsigned char brokenSpeed;
-unsigned char hijumpSpeedA;
-unsigned char hijumpSpeedB;
-unsigned char controlDelay;
-unsigned char fallSpeed;
-
-
-/*Cave elements*/
-
-/*These elements do not require translation*/
-#define E_BLANK (0)
-#define E_ROCK_FULL (1)
-#define E_ROCK_TL (2)
-#define E_ROCK_TR (3)
-#define E_ROCK_BL (4)
-#define E_ROCK_BR (5)
-#define E_ROCK_UNSTABLE (6)
-#define E_LADDER (7)
-#define E_DEATH_BOTTOM_TOP (8)
-#define E_DEATH_TOP_BOTTOM (9)
-
-/*Diamonds. In external representation, there is one code. 
- *Internally, we have three types of diamonds
+/*DLI table of rmt_sup.s, DLI_ENTRIES for each cave display list. An
+ *entry has the font page (0 the cave font) and the colors of the rows
+ *below its DLI. The bands of the cave come first, then the status bar and
+ *the blank lines after it
  */
-#define EXT_E_DIAM (14)
-#define E_DIAM_F (10)
-#define E_DIAM_L (12)
-
-/*Broken rock has one external code and 8 internals for different
- states of decay
+#define DLI_ENTRIES (8)
+#define DLI_BANDS (DLI_ENTRIES - 2)
+#define LOOK_BAND_SIZE (7)
+extern unsigned char dliFont[2 * DLI_ENTRIES];
+extern unsigned char dliPf0[2 * DLI_ENTRIES];
+extern unsigned char dliPf1[2 * DLI_ENTRIES];
+extern unsigned char dliPf2[2 * DLI_ENTRIES];
+extern unsigned char dliPf3[2 * DLI_ENTRIES];
+extern unsigned char dliBk[2 * DLI_ENTRIES];
+extern unsigned char dliStart; /*First entry of the display list shown*/
+unsigned char dliBands; /*Bands of the cave in caveBuffer*/
+
+/*Frame tick, advanced by the VBI*/
+extern unsigned char frameTick;
+unsigned char lastTick; /*Tick the game loop has caught up with*/
+unsigned char frameSteps; /*Core steps owed for the frames passed*/
+unsigned char frameInput; /*Controls for those steps*/
+
+/*Animated tiles - the VBI shows the frames in turn when animOn is set*/
+#define ANIM_FRAMES (4)
+extern unsigned char animOn;
+extern unsigned char animFrame;
+extern unsigned char animDelay;
+extern unsigned char animPages[ANIM_FRAMES]; /*Font page of each frame*/
+
+/*Frames 1-3 of the font of each cave display memory and the font they
+ *were built from
  */
-#define EXT_E_ROCK_BROKEN (15)
-#define E_ROCK_BROKEN_F (13)
-#define E_ROCK_BROKEN_L (20)
-
-/*The skull is a display-only element*/
-#define E_SKULL (21)
-#define E_SKULL_2 (22)
-
-/*Element attribute masks*/
-
-/*                          0  0  0  0  0  0  0  0  0  0  1  1  1  1  1  1  1  1  1  1  2  
-                            0  1  2  3  4  5  6  7  8  9  0  1  2  3  4  5  6  7  8  9  0 */
-const unsigned char passable[] = {1, 0, 0, 0, 0, 0, 0, 1, 0, 0, 1, 1, 1, 0, 0, 0, 0, 0, 0, 0, 0};
-const unsigned char notJump [] = {1, 0, 0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 0, 0, 0, 0, 0, 0, 0, 0};
-const unsigned char broken[] = {0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 1, 1, 1, 1};
-/*                          B  R           R  U  L  D  D  D  D  D  B
- *                          L  O           O  N  A  E  E  I  I  I  R
- *                          A  C           C  S  D  A  A  A  A  A  O
- *                          N  K           K  T  D  D  D  M  M  M  K
- *                          K                       BT TB          1  2  3  4  5  6  7  8
+unsigned char* const animSets[2] = {(unsigned char*) MA_ANIMFONT, (unsigned char*) MA_ANIMFONT2};
+unsigned char* animFonts[2];
+
+/*Next cave - its font frames and then the cave itself, decoded by the
+ *core and painted into the cave display memory not shown. It is made
+ *ready a few steps a frame while the cave before is played, so entering
+ *it is a copy. A step is at most PREP_FONT_BYTES of a frame of the font
+ *or PREP_CELLS + 18 cells of the cave, about 30 scanlines. Steps start
+ *only before VCOUNT PREP_LAST_LINE or after the VBI
  */
+#define PREP_FONT (0)
+#define PREP_CAVE (1)
+#define PREP_FONT_BYTES (256)
+#define PREP_CELLS (20)
+#define PREP_LAST_LINE (104)
+#define PREP_VBI_LINE (124)
+unsigned char prepCave; /*CLM_NO_CAVE when there is none*/
+unsigned char prepBuffer;
+unsigned char prepStage;
+unsigned char* prepFont;
+const unsigned char* prepGlyphs; /*Of the frame being built*/
+unsigned char prepFrame;
+unsigned int prepOffset; /*Bytes of the frame copied*/
+
+/*Frame time meter. VCOUNT counts 2 scanlines, the meter shows scanlines
+ *of a window of METER_WINDOW frames
+ */
+#ifdef CLM_METER
+#define METER_WINDOW (64)
+#define METER_FULL (131) /*A frame of VCOUNT steps, the loop ran late*/
+#define METER_COLUMN (5)
+extern unsigned char meterVbiWorst;
+extern unsigned char meterDliWorst;
+unsigned char meterOn;
+unsigned char meterStart; /*VCOUNT when the frame's work began*/
+unsigned char meterLines;
+unsigned char meterWorst;
+unsigned char meterCount;
+unsigned int meterSum;
+#endif
+
+/*Most frames the game loop catches up at once after running late*/
+#define MAX_CATCH_UP (3)
+
+/*Joystick - JS_LOG_ directions and fire held now, and bits that flip on
+ *every press and release. The VBI writes these, the game only reads them
+ */
+extern unsigned char joyState;
+extern unsigned char joyPressedFlip;
+extern unsigned char joyReleasedFlip;
+extern unsigned char joyHysteresis;
+unsigned char joyPressedSeen; /*Flips taken by joyTakePressed*/
+unsigned char joyReleasedSeen;
+unsigned char menuTick; /*Frame the menu took a direction*/
+
+/*Keypad - a queue of KPAD_ keys pressed, and let go with KEY_RELEASED.
+ *The interrupts move the head, the game moves the tail
+ */
+extern unsigned char keypadCont;
+extern unsigned char keyQueue[KEY_QUEUE_SIZE];
+extern unsigned char keyHead;
+extern unsigned char keyTail;
 
-/*Map cave elements to character pairs*/
-const unsigned char elem2CharMap[] = {
-
-    0, /*BLANK*/
-
-    64 + 128, /*ROCK FULL*/
-
-    72 + 128, /*ROCK TL*/
-    74 + 128, /*ROCK TR*/
-    70 + 128, /*ROCK BL*/
-    68 + 128, /*ROCK BR*/
-
-    90 + 128, /*ROCK UNSTABLE*/
-
-    78, /*LADDER*/
-
-    66 + 128, /*DEATH BOTTOM TOP*/
-    76 + 128, /*DEATH TOP BOTTOM*/
-
-    84, /*DIAM 1*/
-    86, /*DIAM 2*/
-    88, /*DIAM 3*/
-
-    97 + 128, /*BROKEN 1*/
-    99 + 128, /*BROKEN 2*/
-    101 + 128, /*BROKEN 3*/
-    103 + 128, /*BROKEN 4*/
-    105 + 128, /*BROKEN 5*/
-    107 + 128, /*BROKEN 6*/
-    109 + 128, /*BROKEN 7*/
-    111 + 128, /*BROKEN 8*/
-
-    80, /*SKULL*/
-    82 /*SKULL 2*/
-};
+extern unsigned char secondFire;
+extern unsigned char breakHandler;
 
 int main() {
 
@@ -380,11 +372,9 @@ int main() {
     gameSpeed = GAME_SPEED_NORMAL;
     maxCaveReached = 0;
 
-    /*Clear screen*/
-    clrscr();
-
-    /*Relocate music and sound effects*/
-    relocateRmt();
+    /*Nothing to show until the menu*/
+    POKE(0x05, ((unsigned int) &CLM_TEXT_DL_BLANK) % 256);
+    POKE(0x06, ((unsigned int) &CLM_TEXT_DL_BLANK) / 256);
 
     /*Prepare to read keypad*/
     POKE(0x00, 64 + 32+ 128);
@@ -401,9 +391,8 @@ int main() {
     delay(5);
 
     /*Cheat/debug helper.*/
-    if (keypadKey == KPAD_ASTERISK) {
+    if (keyTake() == KPAD_ASTERISK) {
         maxCaveReached = MAX_CAVE_INDEX;
-        keypadKey = KPAD_NONE;
     }
 
     /*Initialize our VBI routine*/
@@ -412,11 +401,6 @@ int main() {
     rmtSetVBI();
     ANTIC.nmien = 64;
 
-    menuDl1 = PEEK(0x05);
-    menuDl2 = PEEK(0x06);
-
-    cursor(0);
-
     /*Init the PMG*/
     pmgInit();
 
@@ -471,52 +455,46 @@ int main() {
         GTIA_WRITE.consol = 0x04;
 
         /*Clear any controls*/
-        while (GTIA_READ.trig0 == 0/* ||
-                PEEK(POT_HORIZONTAL) <JS_LEFT ||
-                PEEK(POT_HORIZONTAL) >JS_RIGHT ||
-                PEEK(POT_VERTICAL)<JS_UP ||
-                PEEK(POT_VERTICAL)>JS_DOWN*/
-                );
+        joyTakePressed();
 
         /*The menu loop*/
         while (1) {
 
+            x1 = menuControls();
+
             /*Start game ?*/
-            if (GTIA_READ.trig0 == 0) {
+            if (x1 & JS_LOG_FIRE) {
                 gameType = GAME_TYPE_NORMAL;
                 break;
             }
 
             /*Starting cave - increase*/
-            if (PEEK(POT_HORIZONTAL) > JS_RIGHT) {
+            if (x1 & JS_LOG_RIGHT) {
                 if (startingCave < maxCaveReached) {
                     startingCave++;
                     displayStartingCave();
-                    delay(15);
                     continue;
                 }
             }
 
             /*Starting cave - decrease*/
-            if (PEEK(POT_HORIZONTAL) < JS_LEFT) {
+            if (x1 & JS_LOG_LEFT) {
                 if (startingCave > 0) {
                     startingCave--;
                     displayStartingCave();
-                    delay(15);
                     continue;
                 }
             }
 
             /*Game speed toggle*/
-            if (PEEK(POT_VERTICAL) > JS_DOWN) {
+            if (x1 & JS_LOG_DOWN) {
                 gameSpeed = 1 - gameSpeed;
                 displayGameSpeed();
-                delay(20);
                 continue;
             }
 
             /*Training*/
-            if (PEEK(POT_VERTICAL) < JS_UP) {
+            if (x1 & JS_LOG_UP) {
                 displayTrainingText();
                 gameType = GAME_TYPE_TRAINING;
                 break;
@@ -527,10 +505,6 @@ int main() {
         /*Set gameover*/
         gameOverType = GAME_OVER_NONE;
 
-        /*Set game speed*/
-        adjustGameSpeed(gameSpeed);
-
-
         /*Setup the music*/
         rmtSuspend();
 
@@ -550,48 +524,21 @@ int main() {
 
 void doGame() {
 
-    /*Joystick*/
-    unsigned char js;
-    unsigned char strig;
-
-    /*Elements near miner*/
-    unsigned char probeBelow;
-    unsigned char probeMiner;
-
-    /*Gravity*/
-    unsigned char fallTimer;
-    unsigned char fallCounter;
-    unsigned char fallLength;
-    unsigned char fallMovementFlags;
-    unsigned char landLock;
-
-
-    /*Broken rock timer*/
-    unsigned char breakTimer;
-
-    /*Quit flag*/
-    unsigned char caveQuit;
-
-    /*High jump in progress flag*/
-    unsigned char hijump;
-
     /*DLI interrupt address*/
     unsigned char* dliadr;
 
 
-    /*Set display list and character set*/
-    POKE(0x05, ((unsigned int) &CLM_DATA_DL_CAVE) % 256);
-    POKE(0x06, ((unsigned int) &CLM_DATA_DL_CAVE) / 256);
+    /*Set current cave, number of lives and game speed*/
+    clmNewGame(gameType, startingCave, gameSpeed);
 
+    /*Cells painted while the cave is shown wait for the VBI*/
+    clmPaintQueued = 1;
 
-    /*Set current cave and number of lives*/
-    if (gameType == GAME_TYPE_NORMAL) {
-        currentCave = startingCave;
-    } else {
-        currentCave = TRAINING_CAVE_INDEX;
-    }
-
-    lives = 4;
+    /*The first cave goes to the second buffer, the menu rows are in the
+     *first one and may still be shown
+     */
+    caveBuffer = 0;
+    prepCave = CLM_NO_CAVE;
 
     /*Set DLI and enable it*/
     dliadr = &dliHandler;
@@ -603,811 +550,503 @@ void doGame() {
     /*Cave loop*/
     while (1) {
 
-        /*Do not show anything*/
-        dmactlStore = PEEK(0x07);
-        POKE(0x07, 0);
-
-        /*Rebuild cave aray*/
-        rebuildCaveElementArray(currentCave);
-        diamondsCollected = 0;
-
-        /*Paint the cave and update status bar*/
-        if ((currentCave & 0x03) < 2) {
-            POKE(0x0D, 12); /*White*/
-            POKE(0x0E, 0x96); /*Blue*/
-            POKE(0x0C, 0x32); /*Dark brown*/
-            POKE(0x0F, 0x34); /*Lighter brown*/
-            POKE(0x10, 0); /*Background*/
-        } else {
-            POKE(0x0D, 12); /*White*/
-            POKE(0x0E, 0xD8); /*Green*/
-            POKE(0x0C, 0x54); /*Dark purple*/
-            POKE(0x0F, 0x56); /*Lighter purple*/
-            POKE(0x10, 0); /*Background*/
-        }
-
-        /*Store the colors for DLI routine*/
-        colorStore1 = PEEK(0x0D);
-        colorStore2 = PEEK(0x0C);
-
-
-        paintCave();
-        updateStatusBar();
-
-        /*Place the miner*/
-        minerData = minerDataNormal;
-        setMinerPos(minerX, minerY);
-
-        /*Initialize game status variables*/
-        stayHere = 1;
-        fallCounter = 0;
-        caveDeath = 0;
-        caveAllPicked = 0;
-        hijump = 0;
-        fallLength = 0;
-        fallMovementFlags = FALL_FLAG_NONE;
-        landLock = 0;
-        caveQuit = 0;
-        probeBelow = E_ROCK_FULL;
-        keypadKey = KPAD_NONE;
-        secondFire = 0;
-
-        /*Show the cave*/
-        POKE(0x07, dmactlStore);
-
-        /*Controls and physics loop*/
-        while (stayHere) {
-
-            /* Read keypad*/
-            if (keypadKey != KPAD_NONE) {
-
-                /*Keypad * or RESET - Return to menu*/
-                if (keypadKey == KPAD_ASTERISK || keypadKey == KPAD_RESET) {
-                    keypadKey = KPAD_NONE;
-                    stayHere = 0;
-                    caveQuit = 1;
-                    break;
-                }
-
-                /*Keypad 0 - Commit Suicide*/
-                if (keypadKey == KPAD_0) {
-                    keypadKey = KPAD_NONE;
-                    caveDeath = 1;
-                    stayHere = 0;
-                    break;
-                }
-
-                /*Keypad PAUSE - Pause game*/
-                if (keypadKey == KPAD_PAUSE) {
-                    handlePause();
-                }
-
+        if (clm.caveDeath) {
 
+            /*Same cave after a death. Only the cells that changed are put
+             *back, the cave stays on the screen. They are written at
+             *once, after the VBI has written the cells still queued, a
+             *frame each look at the queue
+             */
+            while (clmPaintHead != clmPaintTail) {
+                waitFrame();
             }
+            clmRestartCave();
+            updateStatusBar();
 
-            /*Whats is behind the miner a what is below the miner?*/
-            probeMiner = caveElements[minerX][minerY];
-            probeBelow = caveElements[minerX][minerY + 1];
-
-            /*Gravity - If there is nothing below the miner and the miner is not on a ladder, he falls down.*/
-            if (passable[probeBelow] == 1 && probeMiner != E_LADDER && probeBelow != E_LADDER) {
-                if (fallTimer != PEEK(0x02)) {
-                    fallCounter++;
-                    fallTimer = PEEK(0x02);
-                    if (fallCounter == fallSpeed) {
-                        fallDown();
-                        fallLength++;
-                        checkDeath();
-                        fallCounter = 0;
-                        if (fallLength > 6) {
-                            stayHere = 0;
-                            caveDeath = 1;
-                            continue;
-                        }
-                    }
-                }
-                fallMovementFlags |= FALL_FLAG_FALLING;
-                landLock = 0;
-            } else {
-                if ((fallMovementFlags & (FALL_FLAG_LEFT_AND_RIGHT)) != 0) {
-                    landLock = 2;
-                }
-                fallCounter = 0;
-                fallLength = 0;
-                fallMovementFlags = FALL_FLAG_NONE;
-            }
-
-            /*There is a broken rock under the miner. It decays*/
-            if (broken[probeBelow] == 1) {
-                y1 = minerY + 1;
-                if (breakTimer != PEEK(0x02)) {
-                    caveBroken[minerX][y1]++;
-                    breakTimer = PEEK(0x02);
-                }
-                if (caveBroken[minerX][y1] == brokenSpeed) {
-                    caveBroken[minerX][y1] = 0;
-                    if (probeBelow < E_ROCK_BROKEN_L) {
-                        caveElements[minerX][y1]++;
-                        paintElement(minerX, y1, caveElements[minerX][y1]);
-                    } else {
-                        caveElements[minerX][y1] = E_BLANK;
-                        paintElement(minerX, y1, caveElements[minerX][y1]);
-                    }
-                }
-
-            }
+        } else {
 
-            /*Unstable rock under the miner*/
-            if (probeBelow == E_ROCK_UNSTABLE) {
-                caveElements[minerX][minerY + 1] = E_BLANK;
-                paintElement(minerX, minerY + 1, E_BLANK);
+            /*Make the cave ready in the buffer not shown, what is on
+             *the screen stays there meanwhile. After the cave before, it
+             *is ready or nearly so
+             */
+            caveBuffer ^= 1;
+            clmScreen = caveScreens[caveBuffer];
+            prepareCave(clm.currentCave, caveBuffer);
+            while (prepareStep() != 0) {
             }
+            clmEnterCave();
+            setCaveDl();
+            updateStatusBar();
 
-            /*Controls*/
-            if (mvDelay == 0) {
-
-                js = JS_LOG_CENTER;
-
-                if (PEEK(POT_HORIZONTAL) < JS_LEFT) {
-                    js += JS_LOG_LEFT;
-                } else if (PEEK(POT_HORIZONTAL) > JS_RIGHT) {
-                    js += JS_LOG_RIGHT;
-                }
+            /*Show the cave from the next VBI*/
+            showCave();
 
-                if (PEEK(POT_VERTICAL) < JS_UP) {
-                    js += JS_LOG_UP;
-                } else if (PEEK(POT_VERTICAL) > JS_DOWN) {
-                    js += JS_LOG_DOWN;
-                }
-                strig = GTIA_READ.trig0;
-
-
-                switch (js) {
-
-                        /*Joystick right*/
-                    case JS_LOG_UP_RIGHT:
-                    case JS_LOG_RIGHT:
-                    {
-
-                        /*With trigger - Medium jump to right*/
-                        if (strig == 0 && !(notJump[probeBelow])) {
-                            rmtPlayJump();
-                            /*Display miner as jumping one*/
-                            minerData = minerDataJump;
-                            fallLength = 0;
-                            if (jumpUp()) break;
-                            delay(CTRL_DELAY);
-                            if (jumpUp()) break;
-                            delay(CTRL_DELAY);
-                            moveRight();
-                            delay(CTRL_DELAY);
-                            moveRight();
-                            delay(CTRL_DELAY);
-                            moveRight();
-                            delay(CTRL_DELAY);
-                            checkDeath();
-                            /*Display miner as normal*/
-                            minerData = minerDataNormal;
-                            repaintMiner();
-                            break;
-                        }
-                        /*Without trigger - Move to the right*/
-
-                        /*When falling - allow move to the right just once*/
-                        if ((fallMovementFlags & FALL_FLAG_FALLING) == FALL_FLAG_FALLING) {
-                            if ((fallMovementFlags & FALL_FLAG_RIGHT) == 0) {
-                                if (moveRight()) fallMovementFlags |= FALL_FLAG_RIGHT;
-                            }
-                        }/*Otherwise just move to the right*/
-                        else {
-                            if (landLock == 0) {
-                                moveRight();
-                            } else {
-                                --landLock;
-                                mvDelay = controlDelay;
-                            }
-                        }
-
-
-                        checkDeath();
-                        break;
-                    }
-
-                        /*Joystick left*/
-                    case JS_LOG_UP_LEFT:
-                    case JS_LOG_LEFT:
-                    {
-                        /*With trigger - Medium jump to the left*/
-                        if (strig == 0 && !(notJump[probeBelow])) {
-                            /*Medium jump to left*/
-                            rmtPlayJump();
-
-                            /*Display miner as jumping one*/
-                            minerData = minerDataJump;
-
-                            fallLength = 0;
-                            if (jumpUp()) break;
-                            delay(CTRL_DELAY);
-                            if (jumpUp()) break;
-                            delay(CTRL_DELAY);
-                            moveLeft();
-                            delay(CTRL_DELAY);
-                            moveLeft();
-                            delay(CTRL_DELAY);
-                            moveLeft();
-                            delay(CTRL_DELAY);
-                            checkDeath();
-
-                            /*Display miner as normal one*/
-                            minerData = minerDataNormal;
-                            repaintMiner();
-                            break;
-                        }
-                        /*Without trigger - Simply movet to the left*/
-
-                        /*When falling - allow move to the left just once*/
-                        if ((fallMovementFlags & FALL_FLAG_FALLING) == FALL_FLAG_FALLING) {
-                            if ((fallMovementFlags & FALL_FLAG_LEFT) == 0) {
-                                if (moveLeft()) fallMovementFlags |= FALL_FLAG_LEFT;
-                            }
-                        }/*Otherwise just move to the left*/
-                        else {
-                            if (landLock == 0) {
-                                moveLeft();
-                            } else {
-                                --landLock;
-                                mvDelay = controlDelay;
-                            }
-
-                        }
-                        checkDeath();
-                        break;
-                    }
-
-
-                        /*Joystick down, move down (ladder only)*/
-                    case JS_LOG_DOWN:
-                    {
-                        moveDown();
-                        checkDeath();
-                        break;
-                    }
-
-                        /*Joystick up, move up (ladder only) or jump high*/
-                    case JS_LOG_UP:
-                    {
-                        if (strig == 0) {
-                            if (notJump[probeBelow]) break;
-                            fallLength = 0;
-                            rmtPlayJump();
-                            handleHighJump();
-                            break;
-                        }
-                        moveUp();
-                        checkDeath();
-                        break;
-                    }
-
-                    default:
-                    {
-                        mvDelay = 0;
-                        landLock = 0;
-                    }
-
-                }/*End switch js*/
+            /*Then the cave after it*/
+            prepCave = CLM_NO_CAVE;
+            if (clm.gameType == GAME_TYPE_NORMAL && clm.currentCave + 1 < NUMBER_OF_CAVES) {
+                prepareCave(clm.currentCave + 1, caveBuffer ^ 1);
             }
-
-        }/*End of controls and physics loop*/
-
-        /* Return to main menu by user request*/
-        if (caveQuit) {
-            /*Hide the miner*/
-            setMinerPos(-8, 32);
-            gameOverType = GAME_OVER_USER_QUIT;
-            break;
         }
 
-        /* Treasure collected. Advance to next cave or complete the game*/
-        if (caveAllPicked) {
+        keyTail = keyHead;
+        secondFire = 0;
 
-            /*If training, then return to the main menu*/
-            if (gameType == GAME_TYPE_TRAINING) {
-                setMinerPos(-8, 32);
-                gameOverType = GAME_OVER_USER_QUIT;
-                break;
-            }
+        /*Place the miner from the next VBI*/
+        minerFrame = MINER_NORMAL;
+        setMinerPos(clm.minerX, clm.minerY);
 
-            currentCave++;
-            if (currentCave == NUMBER_OF_CAVES) {
-                /*Hide the miner*/
+        /*Controls and physics loop - one core step per frame. Frames missed
+         *while busy are caught up before the miner is shown again
+         */
+        lastTick = frameTick;
+        while (1) {
+            frameSteps = waitFrame();
+#ifdef CLM_METER
+            meterStart = ANTIC.vcount;
+#endif
+            if (frameSteps > MAX_CATCH_UP) frameSteps = MAX_CATCH_UP;
+            frameInput = readControls();
+            while (frameSteps != 0 && clmStep(frameInput) != 0) --frameSteps;
+            if (frameSteps != 0) break;
+            syncMiner();
+#ifdef CLM_METER
+            meterFrame();
+#endif
+            prepareIdle();
+        }
+
+        /*Hide the miner unless the game continues*/
+        if (clm.caveQuit || clm.caveAllPicked) {
+            if (clmEndCave() != GAME_OVER_NONE) {
                 setMinerPos(-8, 32);
-                /*Show congratulations screen before menu*/
-                gameOverType = GAME_OVER_SUCCESS;
                 break;
-            } else {
-                if (currentCave > maxCaveReached) maxCaveReached = currentCave;
             }
-            /*Play positive sound*/
-            rmtPlayPicked();
+            if (clm.currentCave > maxCaveReached) maxCaveReached = clm.currentCave;
             continue;
         }
-        if (caveDeath) {
-
-            /*Let the miner fall to the ground if possible*/
-            if ((fallMovementFlags & FALL_FLAG_FALLING) == FALL_FLAG_FALLING) {
-                while (minerY < 22 && (caveElements[minerX][minerY + 1] == E_BLANK)) {
-                    minerY++;
-                    setMinerPos(minerX, minerY);
-                    delay(3);
-                }
-            }
 
-            /*Let the miner dissapear*/
-            setMinerPos(-8, 32);
-
-            /*Display a skull with blinking eye*/
-            paintElement(minerX, minerY, E_SKULL);
-            rmtPlayDeath();
-            delay(15);
-            paintElement(minerX, minerY, E_SKULL_2);
-            delay(15);
-            paintElement(minerX, minerY, E_SKULL);
-            delay(5);
-
-            /*Check remaining lives lives*/
-            if (lives == 0) {
-                gameOverType = GAME_OVER_DEATH;
-                break;
-            }
-            lives--;
+        /*Death*/
 
-            continue;
+        /*Let the miner fall to the ground if possible*/
+        syncMiner();
+        if ((clm.fallMovementFlags & FALL_FLAG_FALLING) == FALL_FLAG_FALLING) {
+            while (clm.minerY < 22 && (clm.caveElements[CLM_CELL(clm.minerX, clm.minerY + 1)] == E_BLANK)) {
+                clm.minerY++;
+                setMinerPos(clm.minerX, clm.minerY);
+                delay(3);
+            }
         }
 
+        /*Let the miner dissapear*/
+        setMinerPos(-8, 32);
+
+        /*Display a skull with blinking eye*/
+        paintElement(clm.minerX, clm.minerY, E_SKULL);
+        rmtPlayDeath();
+        delay(15);
+        paintElement(clm.minerX, clm.minerY, E_SKULL_2);
+        delay(15);
+        paintElement(clm.minerX, clm.minerY, E_SKULL);
+        delay(5);
 
+        /*Check remaining lives lives*/
+        if (clmEndCave() != GAME_OVER_NONE) break;
 
     }/*End of outer loop*/
 
+    gameOverType = clm.gameOverType;
+    clmPaintQueued = 0;
+
     /*Inhibit DLI*/
     ANTIC.nmien = 96;
 }
 
-/*Paint element at specific location*/
-void paintElement(unsigned char x, unsigned char y, unsigned char elem) {
+/*Start making a cave ready in a buffer, unless it is under way. The
+ *character set is by even cave or odd cave
+ */
+void prepareCave(unsigned char cv, unsigned char buffer) {
 
-    /*Target memory*/
-    i2 = MA_CAVDMEM + (y * 40)+(x << 1);
+    if (cv == prepCave && buffer == prepBuffer) return;
 
-    /*Mapping for element*/
-    z1 = elem2CharMap[elem];
+    prepCave = cv;
+    prepBuffer = buffer;
+    if ((cv & 0x01U) != 0) {
+        prepFont = &CLM_DATA_CHSET2;
+        prepGlyphs = CLM_ANIM_CHSET2;
+    } else {
+        prepFont = &CLM_DATA_CHSET1;
+        prepGlyphs = CLM_ANIM_CHSET1;
+    }
 
-    POKE(i2, z1);
-    POKE(i2 + 1, z1 + 1);
+    /*Frames that are built already*/
+    if (animFonts[buffer] == prepFont) {
+        prepStage = PREP_CAVE;
+        clmPrepareCave(cv, caveScreens[buffer]);
+        return;
+    }
 
+    animFonts[buffer] = NULL;
+    prepFrame = 1;
+    prepOffset = 0;
+    prepStage = PREP_FONT;
 }
 
-/*Paint whole cave*/
-void paintCave() {
+/*One step of the next cave, 0 when it is ready*/
+unsigned char prepareStep() {
 
-    for (y1 = 0; y1 < 22; ++y1) {
-        for (x1 = 0; x1 < 20; ++x1) {
-            paintElement(x1, y1, caveElements[x1][y1]);
-        }
+    if (prepCave == CLM_NO_CAVE) return 0;
+
+    if (prepStage == PREP_FONT) {
+        if (buildAnimStep() != 0) return 1;
+        prepStage = PREP_CAVE;
+        clmPrepareCave(prepCave, caveScreens[prepBuffer]);
+        return 1;
     }
+
+    /*The core decoded a cave of its own meanwhile, start again*/
+    if (clmPreparedCave != prepCave) {
+        clmPrepareCave(prepCave, caveScreens[prepBuffer]);
+    }
+    return clmPrepareStep(PREP_CELLS);
 }
 
-/*Rebuild cave*/
-void rebuildCaveElementArray(unsigned char cv) {
+/*Steps of the next cave while the frame has time for them*/
+void prepareIdle() {
 
-    /*Elements*/
-    unsigned char elems[2];
-    int ec = 0;
+    while (frameTick == lastTick) {
+        x1 = ANTIC.vcount;
+        if (x1 >= PREP_LAST_LINE && x1 < PREP_VBI_LINE) return;
+        if (prepareStep() == 0) return;
+    }
+}
 
+/*Show the cave painted in caveBuffer. Right after a VBI, so the display
+ *list, the colors and the font all change in the next one
+ */
+void showCave() {
+    lastTick = frameTick;
+    waitFrame();
+    POKE(0x05, (unsigned int) caveDls[caveBuffer] % 256);
+    POKE(0x06, (unsigned int) caveDls[caveBuffer] / 256);
+    dliStart = caveBuffer * DLI_ENTRIES;
+    setCaveLook();
+}
 
-    /*Element Pointer*/
-    unsigned char* p;
+/*Display list of the cave painted in caveBuffer, a DLI on the row above
+ *each band of its look
+ */
+void setCaveDl() {
 
-    /*Coordinates*/
-    unsigned char x, y;
+    unsigned char* dl = caveDls[caveBuffer];
+    const unsigned char* band = CLM_DATA_LOOKS[clm.currentCave] + 5;
 
-    /*Determine character set (even cave or odd cave)*/
-    if ((cv & 0x01U) != 0) {
-        ANTIC.chbase = (((unsigned int) &CLM_DATA_CHSET2) >> 8);
-    } else {
-        ANTIC.chbase = (((unsigned int) &CLM_DATA_CHSET1) >> 8);
+    memcpy(dl, caveDlTemplates[caveBuffer], CAVE_DL_SIZE);
+    for (x1 = 0; x1 < DLI_BANDS && band[0] != 0; ++x1) {
+        /*Row 0 is the one with the address*/
+        y1 = band[0] - 1;
+        dl[y1 == 0 ? 3 : 5 + y1] |= 128;
+        band += LOOK_BAND_SIZE;
     }
+    setDliEntries();
+}
 
+/*DLI table of the cave in caveBuffer, from its look*/
+void setDliEntries() {
+
+    const unsigned char* look = CLM_DATA_LOOKS[clm.currentCave];
+    const unsigned char* band = look + 5;
+    unsigned char e = caveBuffer * DLI_ENTRIES;
+
+    for (dliBands = 0; dliBands < DLI_BANDS && band[0] != 0; ++dliBands) {
+        dliFont[e] = band[1];
+        dliPf0[e] = band[2];
+        dliPf1[e] = band[3];
+        dliPf2[e] = band[4];
+        dliPf3[e] = band[5];
+        dliBk[e] = band[6];
+        band += LOOK_BAND_SIZE;
+        ++e;
+    }
 
-    /*Point to the cave beginning*/
-    p = (unsigned char*) (&CLM_DATA_CAVES);
-    p += cv*CAVESIZE;
-
-    /*Reset number of diamonds in the cave*/
-    diamondsInCave = 0;
-
-    /*Determine miner position*/
-    minerY = *p;
-    p++;
-    minerX = *p;
-    p++;
-
-    for (y = 0; y < 22; y++) {
-        for (x = 0; x < 20; x += 2) {
-
-            elems[0] = (*(p) >> 4);
-            elems[1] = (*(p)&0x0F);
-
-            for (ec = 0; ec < 2; ec++) {
-
-                /*Translate special elements*/
-                switch (elems[ec]) {
-                    case EXT_E_DIAM:
-                    {
-                        diamondsInCave++;
-                        elems[ec] = E_DIAM_F + (diamondsInCave % 3);
-                        break;
-                    }
-                    case EXT_E_ROCK_BROKEN:
-                    {
-                        elems[ec] = E_ROCK_BROKEN_F;
-                        break;
-                    }
-                }
-            }
-
-            caveElements[x][y] = elems[0];
-            caveElements[x + 1][y] = elems[1];
-            p++;
+    /*Status bar - white text on dark background*/
+    dliFont[e] = 0;
+    dliPf0[e] = look[0];
+    dliPf1[e] = 12;
+    dliPf2[e] = 48;
+    dliPf3[e] = look[3];
+    dliBk[e] = look[4];
+    ++e;
+
+    /*Blank lines after it, the top of the cave again*/
+    dliFont[e] = 0;
+    dliPf0[e] = look[0];
+    dliPf1[e] = look[1];
+    dliPf2[e] = look[2];
+    dliPf3[e] = look[3];
+    dliBk[e] = look[4];
+}
 
-        }
-    }
+/*Colors of the top of the current cave, its font from frame 0 on*/
+void setCaveLook() {
 
+    memcpy((unsigned char*) 0x0C, CLM_DATA_LOOKS[clm.currentCave], 5);
 
-    /*Clear the broken array*/
-    memset(caveBroken, 0, 440);
+    /*The frames of the font of the buffer shown, the VBI sets
+     *ANTIC.chbase for frame 0 first
+     */
+    animPages[0] = ((unsigned int) animFonts[caveBuffer]) >> 8;
+    for (x1 = 1; x1 < ANIM_FRAMES; ++x1) {
+        animPages[x1] = (((unsigned int) animSets[caveBuffer]) >> 8) + ((x1 - 1) << 2);
+    }
+    animFrame = ANIM_FRAMES - 1;
+    animDelay = 1;
+    animOn = 1;
 }
 
-/*Player missile graphics*/
-void pmgInit() {
+/*Translate joystick, trigger and keypad to the logical input of the core*/
+unsigned char readControls() {
 
-    /*Set PMG memory start*/
-    ANTIC.pmbase = MA_PMGPAGE;
+    unsigned char key;
 
-    /*PMG single line resolution*/
-    POKE(0x07, 62);
+    /* Read keypad, keys let go are of no interest*/
+    while ((key = keyTake()) != KPAD_NONE) {
 
-    /*Clear all PMG memory*/
-    memset((void*) MA_PMGSTART, 0, (MA_PMGEND - MA_PMGSTART + 1));
+        /*Keypad * or RESET - Return to menu*/
+        if (key == KPAD_ASTERISK || key == KPAD_RESET) {
+            return KP_LOG_QUIT;
+        }
 
-    /*Enable PMG*/
-    GTIA_WRITE.gractl = 2;
+        /*Keypad 0 - Commit Suicide*/
+        if (key == KPAD_0) {
+            return KP_LOG_SUICIDE;
+        }
 
-    /*Player 0 will be green*/
-    POKE(0x08, 0xC8);
+        /*Keypad PAUSE - Pause game*/
+        if (key == KPAD_PAUSE) {
+            handlePause();
+        }
 
-    /*Initial coordinates*/
-    p0x = 128;
-    GTIA_WRITE.hposp0 = p0x;
-    p0y = 0;
+#ifdef CLM_METER
+        /*Keypad # - Frame time meter on and off*/
+        if (key == KPAD_HASH) {
+            meterOn ^= 1;
+            if (meterOn == 0) updateStatusBar();
+        }
+#endif
+    }
 
+    return joyState;
 }
 
-/*Place miner at given coordinates*/
-void setMinerPos(unsigned char x, unsigned char y) {
-    p0x = 48 + (x << 3);
-    memset(((unsigned char*) p0y + MA_PMGSTART + 1024), 0, 8);
-    p0y = 32 + (y << 3);
-    GTIA_WRITE.hposp0 = p0x;
-    memcpy((unsigned char*) p0y + MA_PMGSTART + 1024, minerData, 8);
-}
+/*Controls pressed since the last call*/
+unsigned char joyTakePressed() {
+    unsigned char flip = joyPressedFlip;
+    unsigned char pressed = flip ^ joyPressedSeen;
 
-/*Just repaint the miner*/
-void repaintMiner() {
-    memcpy(((unsigned char*) (32 + (minerY << 3) + MA_PMGSTART + 1024)), minerData, 8);
+    joyPressedSeen = flip;
+    return pressed;
 }
 
-/*Wait for some time*/
-void delay(unsigned int w) {
-    unsigned int i = 0;
-    for (i = 0; i < w; i++) {
-        unsigned char a = PEEK(0x02);
-        while (PEEK(0x02) == a) {
-        }
-    }
-}
+/*Controls let go since the last call*/
+unsigned char joyTakeReleased() {
+    unsigned char flip = joyReleasedFlip;
+    unsigned char released = flip ^ joyReleasedSeen;
 
-/*Move commands with range and pass checking*/
-unsigned char moveLeft() {
-    if (minerX == 0 || passable[caveElements[minerX - 1][minerY]] == 0) return 0;
-    minerX--;
-    setMinerPos(minerX, minerY);
-    checkTreasure();
-    mvDelay = controlDelay;
-    return 1;
+    joyReleasedSeen = flip;
+    return released;
 }
 
-unsigned char moveRight() {
-    if (minerX == 19 || passable[caveElements[minerX + 1][minerY]] == 0) return 0;
-    minerX++;
-    setMinerPos(minerX, minerY);
-    checkTreasure();
-    mvDelay = controlDelay;
-    return 1;
-}
+/*Menu controls - just pressed, or directions held for MENU_REPEAT frames*/
+unsigned char menuControls() {
+    unsigned char c = joyTakePressed();
 
-void moveDown() {
-    if (minerY == 21) return;
-    x1 = caveElements[minerX][minerY + 1];
-    if (passable[x1] == 1) {
-        minerY++;
-        setMinerPos(minerX, minerY);
-        checkTreasure();
-        mvDelay = controlDelay;
+    if (c == 0 && (joyState & JS_LOG_DIRECTIONS) != 0
+            && (unsigned char) (frameTick - menuTick) >= MENU_REPEAT) {
+        c = joyState & JS_LOG_DIRECTIONS;
     }
+    if (c != 0) menuTick = frameTick;
+    return c;
 }
 
-void fallDown() {
-    if (minerY == 21) return;
-    x1 = caveElements[minerX][minerY + 1];
-    if (passable[x1] == 1) {
-        minerY++;
-        setMinerPos(minerX, minerY);
-        checkTreasure();
+/*Wait for FIRE pressed from now on. Holding it from before does not count*/
+void waitFire() {
+    joyTakePressed();
+    while ((joyTakePressed() & JS_LOG_FIRE) == 0) {
     }
 }
 
-void moveUp() {
-    if (minerY == 0) return;
-    x1 = caveElements[minerX][minerY - 1];
-    /*Not free*/
-    if (passable[x1] == 0) return;
-
-    /*We can move up only when we are on the ladder a passable element is above*/
-    if (caveElements[minerX][minerY] == E_LADDER) {
-        /*Into death*/
-        if (x1 == E_DEATH_TOP_BOTTOM) {
-            stayHere = 0;
-            caveDeath = 1;
-            return;
-        }
-        minerY--;
-        setMinerPos(minerX, minerY);
-        checkTreasure();
-        mvDelay = controlDelay;
-
-    }
+/*Next keypad event, KPAD_NONE when there is none*/
+unsigned char keyTake() {
+    unsigned char key;
 
+    if (keyTail == keyHead) return KPAD_NONE;
+    key = keyQueue[keyTail];
+    keyTail = (keyTail + 1) & (KEY_QUEUE_SIZE - 1);
+    return key;
 }
 
-unsigned char jumpUp() {
-    if (minerY == 0) return 0;
-    x1 = caveElements[minerX][minerY - 1];
-    /*Into death*/
-    if (x1 == E_DEATH_TOP_BOTTOM) {
-        stayHere = 0;
-        caveDeath = 1;
-        return 1;
-    }
-    /*Not free*/
-    if (passable[x1] == 0) return 0;
+/*Show the miner where the core has put him*/
+void syncMiner() {
 
-    minerY--;
-    setMinerPos(minerX, minerY);
-    checkTreasure();
-    return 0;
+    /*Jumping miner or normal miner, the VBI repaints it*/
+    minerFrame = (clm.jumpType != JUMP_NONE) ? MINER_JUMP : MINER_NORMAL;
+
+    if (clm.minerX != minerShownX || clm.minerY != minerShownY) {
+        glideMiner(clm.minerX, clm.minerY);
+    }
 }
 
-/*This is special function to handle high jump.*/
-void handleHighJump() {
+/*Player missile graphics*/
+void pmgInit() {
 
-    unsigned char hjMaxTicks = hijumpSpeedA;
-    unsigned char hjTicks = 0;
-    unsigned char hjFlipFlop;
+    /*Set PMG memory start*/
+    ANTIC.pmbase = MA_PMGPAGE;
 
-    /*Jumping miner*/
-    minerData = minerDataJump;
+    /*PMG single line resolution*/
+    POKE(0x07, 62);
 
+    /*Clear all PMG memory*/
+    memset((void*) MA_PMGSTART, 0, (MA_PMGEND - MA_PMGSTART + 1));
 
-    y1 = 0; /*Side move flag*/
-    hiJump = 3; /*Jump power - 3 steps*/
-    mvDelay = 0; /*Reset Movement delay*/
+    /*Enable PMG*/
+    GTIA_WRITE.gractl = 2;
 
-    /*When there is still jump power*/
-    while (hiJump > 0) {
+    /*Player 0 will be green*/
+    POKE(0x08, 0xC8);
 
-        /*If the miner is blocked - jump is complete*/
-        if (jumpUp()) break;
+    /*Initial coordinates*/
+    GTIA_WRITE.hposp0 = 0;
 
-        /*Time window for side movement*/
-        while (hjTicks < hjMaxTicks) {
+}
 
-            /*Time to allow controls*/
-            if (mvDelay == 0) {
+/*Place miner at given coordinates, shown from the next frame*/
+void setMinerPos(unsigned char x, unsigned char y) {
+    glideMiner(x, y);
+    minerSnap = 1;
+}
 
-                hijs = JS_LOG_CENTER;
-                if (PEEK(POT_HORIZONTAL) < JS_LEFT) {
-                    hijs = JS_LOG_LEFT;
-                } else if (PEEK(POT_HORIZONTAL) > JS_RIGHT) {
-                    hijs = JS_LOG_RIGHT;
-                }
+/*Let the VBI move the miner to given coordinates over the next frames*/
+void glideMiner(unsigned char x, unsigned char y) {
+    minerShownX = x;
+    minerShownY = y;
+    minerTargetX = 48 + (x << 3);
+    minerTargetY = 32 + (y << 3);
+}
 
-                /*Allow only single left or right move during the jump*/
-                switch (hijs) {
-                    case (JS_LOG_LEFT):
-                    {
-                        if (y1) break;
-                        if (moveLeft()) y1 = 1;
-                        break;
-                    }
-                    case (JS_LOG_RIGHT):
-                    {
-                        if (y1) break;
-                        if (moveRight()) y1 = 1;
-                        break;
-                    }
-                    default:
-                    {
-                        mvDelay = 0;
-                        break;
-                    }
-                }/*End of switch hiJS*/
+/*Wait for the VBI to signal the next frame, return how many have passed.
+ *The time spent here is what the game loop leaves unused
+ */
+unsigned char waitFrame() {
+    unsigned char n;
 
-            }
-            if (hjFlipFlop != PEEK(0x02)) {
-                hjFlipFlop = PEEK(0x02);
-                hjTicks++;
-            }
-        }
-        if (hiJump == 2) hjMaxTicks = hijumpSpeedB;
-        hjTicks = 0;
-        hiJump--;
+    while (frameTick == lastTick) {
     }
-    /*Jump is ended*/
-    /*Check for death*/
-    checkDeath();
-
-    /*Normal miner*/
-    minerData = minerDataNormal;
-    repaintMiner();
-
+    n = frameTick - lastTick;
+    lastTick += n;
+    return n;
 }
 
-void checkDeath() {
-    x1 = caveElements[minerX][minerY + 1];
-    if (x1 == E_DEATH_BOTTOM_TOP) {
-        stayHere = 0;
-        caveDeath = 1;
-    }
-}
+#ifdef CLM_METER
+/*Account the work of this frame, show the window when it is complete*/
+void meterFrame() {
 
-unsigned char checkTreasure() {
-    x1 = caveElements[minerX][minerY];
-    if (x1 >= E_DIAM_F && x1 <= E_DIAM_L) {
-        diamondsCollected++;
-        caveElements[minerX][minerY] = E_BLANK;
-        paintElement(minerX, minerY, E_BLANK);
-        rmtPlayDiamond();
-        if (diamondsCollected == diamondsInCave) {
-            stayHere = 0;
-            caveAllPicked = 1;
-        }
-        return 1;
+    /*Still in the frame the work began in?*/
+    if (frameTick != lastTick) {
+        meterLines = METER_FULL;
+    } else {
+        meterLines = ANTIC.vcount;
+        if (meterLines < meterStart) meterLines += METER_FULL;
+        meterLines -= meterStart;
     }
-    return 0;
-}
 
-void updateStatusBar() {
+    meterSum += meterLines;
+    if (meterLines > meterWorst) meterWorst = meterLines;
+    if (++meterCount != METER_WINDOW) return;
 
-    /*Clear*/
-    memset((unsigned char*) MA_SBMEM, 0, 40);
+    if (meterOn) meterShow();
+    meterCount = 0;
+    meterSum = 0;
+    meterWorst = 0;
+    meterVbiWorst = 0;
+    meterDliWorst = 0;
+}
 
-    /*Lives*/
-    for (y1 = 0; y1 < lives; y1++) {
-        POKE(MA_SBMEM + y1, 123);
-    }
+/*Scanlines in the status bar - F average/worst of the game loop,
+ *V the VBI, D the DLIs
+ */
+void meterShow() {
+
+    unsigned char* s = STATUS_BAR + METER_COLUMN;
+
+    memset(s, 0, 21);
+    s[0] = 38; /*F*/
+    meterNumber(s + 2, (meterSum / METER_WINDOW) << 1);
+    s[5] = 15; /*Slash*/
+    meterNumber(s + 6, meterWorst << 1);
+    s[10] = 54; /*V*/
+    meterNumber(s + 12, meterVbiWorst << 1);
+    s[16] = 36; /*D*/
+    meterNumber(s + 18, meterDliWorst << 1);
+}
 
-    /*Current cave*/
-    if (gameType == GAME_TYPE_TRAINING) {
-        memcpy((char*) (MA_SBMEM + 32), trainingLiteral, 8);
-    } else {
-        x1 = (40 - NUMBER_OF_CAVES) + currentCave + 1;
-        for (y1 = 40 - NUMBER_OF_CAVES; y1 < x1; y1++) {
-            POKE(MA_SBMEM + y1, 96);
+/*Three digits*/
+void meterNumber(unsigned char* s, unsigned int n) {
+    s[2] = 16 + n % 10;
+    n /= 10;
+    s[1] = 16 + n % 10;
+    s[0] = 16 + n / 10;
+}
+#endif
+
+/*Wait for some time*/
+void delay(unsigned int w) {
+    unsigned int i = 0;
+    for (i = 0; i < w; i++) {
+        unsigned char a = PEEK(0x02);
+        while (PEEK(0x02) == a) {
         }
     }
-
 }
 
 /*Display main menu*/
 void displayMainMenu() {
 
-    /*Disable DMA and setup display list*/
-    dmactlStore = PEEK(0x07);
-    POKE(0x07, 0);
-    POKE(0x05, menuDl1);
-    POKE(0x06, menuDl2);
-
-    /*Set colors*/
-    setTextModeSettings();
-    clrscr();
-    cursor(0);
-
-    /*Game title*/
-
-    /*             12345678901234567890 */
-    cputsxy(0, 0, "    CURSE OF THE");
-    cputsxy(0, 1, "     LOST MINER");
-    cputsxy(0, 3, "BAKTRA SOFTWARE 2015");
-
-    /*Description of menu controls*/
-    cputsxy(1, 8, "FIRE    start game");
-    cputsxy(1, 10, "JS L/R  cave");
-    cputsxy(1, 11, "JS DOWN speed");
-    cputsxy(1, 13, "JS UP   training");
-
-    /*Instructions*/
-    cputsxy(1, 20, "guide the miner");
-    cputsxy(1, 21, "through dangerous");
-    cputsxy(1, 22, "caves and collect");
-    cputsxy(1, 23, "all diamonds");
-
-    /*Variable portions*/
+    /*The rows that change are in RAM, the rest in the cartridge*/
+    memcpy((unsigned char*) MA_MENUROWS, CLM_TEXT_MENU_ROWS, 40);
     displayStartingCave();
     displayGameSpeed();
 
-    /*Reenable DMA*/
-    POKE(0x07, dmactlStore);
+    dmactlStore = PEEK(0x07);
+    showTextScreen(&CLM_TEXT_DL_MENU);
 }
 
 /*Display game speed*/
 void displayGameSpeed() {
     if (gameSpeed == GAME_SPEED_NORMAL) {
-        cputsxy(15, 11, "NORM");
+        memcpy((unsigned char*) (MA_MENUROWS + 20 + MENU_COLUMN), CLM_TEXT_NORM, 4);
     } else {
-        cputsxy(15, 11, "SLOW");
+        memcpy((unsigned char*) (MA_MENUROWS + 20 + MENU_COLUMN), CLM_TEXT_SLOW, 4);
     }
 }
 
 void displayStartingCave() {
-    gotoxy(15, 10);
-    cprintf("%02d", startingCave + 1);
+    writeNumber2((unsigned char*) (MA_MENUROWS + MENU_COLUMN), startingCave + 1);
 }
 
-void adjustGameSpeed(unsigned char speed) {
-    /*Normal game speed*/
-    if (speed == GAME_SPEED_NORMAL) {
-
-        brokenSpeed = 17;
-        hijumpSpeedA = 6;
-        hijumpSpeedB = 20;
-        controlDelay = 8;
-        fallSpeed = 4;
-
-    }/*Slower game speed*/
-    else {
-        brokenSpeed = 25;
-        hijumpSpeedA = 8;
-        hijumpSpeedB = 26;
-        controlDelay = 8;
-        fallSpeed = 5;
+/*Two digits of a number below 100*/
+void writeNumber2(unsigned char* s, unsigned char n) {
+    s[0] = SC_DIGITS;
+    while (n >= 10) {
+        n -= 10;
+        ++s[0];
     }
-
+    s[1] = SC_DIGITS + n;
 }
 
 /*Show Congratulations*/
 void displayCongratulations() {
 
-    /*Use the menu DL*/
-    POKE(0x07, 0);
-    POKE(0x05, menuDl1);
-    POKE(0x06, menuDl2);
-    clrscr(); /*1234567890123456789012345678901234567890*/
-    cputsxy(2, 4, "CONGRATULATIONS");
-    cputsxy(2, 6, "the curse of the");
-    cputsxy(2, 7, "lost miner");
-    cputsxy(2, 8, "has been broken");
-    setTextModeSettings();
-    POKE(0x07, dmactlStore);
+    showTextScreen(&CLM_TEXT_DL_CONGRATULATIONS);
     delay(50);
 
     for (x1 = 0; x1 < 3; x1++) {
@@ -1416,8 +1055,8 @@ void displayCongratulations() {
     }
 
     delay(100);
-    cputsxy(2, 13, "press FIRE");
-    while (GTIA_READ.trig0 != 0);
+    showHiddenText();
+    waitFire();
 
 
 }
@@ -1425,40 +1064,19 @@ void displayCongratulations() {
 /*Show game over*/
 void displayGameOver() {
 
-    /*Use the menu DL*/
-    POKE(0x07, 0);
-    POKE(0x05, menuDl1);
-    POKE(0x06, menuDl2);
-
-    clrscr(); /*1234567890123456789012345678901234567890*/
-    cputsxy(4, 11, "game is over");
-
-    /*Show the screen again*/
-    setTextModeSettings();
-    POKE(0x07, dmactlStore);
+    showTextScreen(&CLM_TEXT_DL_GAME_OVER);
     delay(150);
 
-    cputsxy(5, 13, "press FIRE");
+    showHiddenText();
 
-    while (GTIA_READ.trig0 != 0);
+    waitFire();
 
 }
 
 /*Display "Returning to the main menu ...*/
 void displayReturnToMenuScreen() {
 
-    /*Use the menu DL*/
-
-    POKE(0x07, 0);
-    POKE(0x05, menuDl1);
-    POKE(0x06, menuDl2);
-
-    /*Just blank screen*/
-    clrscr();
-    cputsxy(0, 10, "returning to menu...");
-    /*Show the screen again*/
-    setTextModeSettings();
-    POKE(0x07, dmactlStore);
+    showTextScreen(&CLM_TEXT_DL_RETURN);
 
     /*Wait for a while*/
     delay(125);
@@ -1468,60 +1086,69 @@ void displayReturnToMenuScreen() {
 /*Display instructions*/
 void displayTrainingText() {
 
-    /*Clear screen*/
-    clrscr();
     setMinerPos(-8, 32);
-    /*12345678901234567890*/
-    cputsxy(0, 0, "use joystick to");
-    cputsxy(0, 1, "control the miner");
-
-    /*Movement*/
-    cputsxy(0, 3, "MOVEMENT");
-    cputsxy(0, 4, "js left  left");
-    cputsxy(0, 5, "js right right");
-    cputsxy(0, 6, "js up   up(ladder)");
-    cputsxy(0, 7, "js down down(ladder)");
-
-    /*Jumps*/
-    cputsxy(0, 9, "JUMPING");
-    cputsxy(0, 10, "fire+up");
-    cputsxy(0, 11, "high jump");
-
-    cputsxy(0, 12, "fire+left or right");
-    cputsxy(0, 13, "long jumps");
-
-    cputsxy(0, 15, "miner can jump only");
-    cputsxy(0, 16, "when there is a rock");
-    cputsxy(0, 17, "or a ladder below");
-
-    cputsxy(0, 19, "avoid spikes");
-    cputsxy(0, 20, "press 0 for suicide");
-    cputsxy(0, 21, "press * for menu");
+    showTextScreen(&CLM_TEXT_DL_TRAINING);
 
+    /*Wait for FIRE button*/
+    waitFire();
 
-    cputsxy(0, 23, "press FIRE");
+}
 
-    /*Wait for FIRE button*/
-    while (GTIA_READ.trig0 != 0);
+/*Show a prebuilt text screen, nothing is copied. DMA is off while the
+ *display list changes
+ */
+void showTextScreen(unsigned char* dl) {
+    POKE(0x07, 0);
+    POKE(0x05, (unsigned int) dl % 256);
+    POKE(0x06, (unsigned int) dl / 256);
+    setTextModeSettings();
+    POKE(0x07, dmactlStore);
+}
 
+/*Text in COLPF2 and COLPF3 shows in the colors of the other text*/
+void showHiddenText() {
+    POKE(0x0E, 255);
+    POKE(0x0F, 14);
 }
 
 /*Colors and character set for text mode*/
 void setTextModeSettings() {
     POKE(0x0C, 255); /*Capitals - emphasize*/
     POKE(0x0D, 14); /*Minuscules - normal*/
+    POKE(0x0E, 50); /*Hidden text, see showHiddenText()*/
+    POKE(0x0F, 50);
     POKE(0x10, 50); /*Background*/
+    animOn = 0;
     ANTIC.chbase = 0xF8;
 }
 
+/*Build a part of the frames 1-3 of the font of the next cave in RAM -
+ *copies of the font with the animated characters replaced. Returns 0
+ *when they are built
+ */
+unsigned char buildAnimStep() {
+
+    unsigned char* frame = animSets[prepBuffer] + ((prepFrame - 1) << 10);
+
+    memcpy(frame + prepOffset, prepFont + prepOffset, PREP_FONT_BYTES);
+    prepOffset += PREP_FONT_BYTES;
+    if (prepOffset != 1024) return 1;
+
+    for (y1 = 0; CLM_ANIM_CHARS[y1] != 0; ++y1) {
+        memcpy(frame + (CLM_ANIM_CHARS[y1] << 3), prepGlyphs, 8);
+        prepGlyphs += 8;
+    }
+    prepOffset = 0;
+    if (++prepFrame != ANIM_FRAMES) return 1;
+
+    animFonts[prepBuffer] = prepFont;
+    return 0;
+}
+
 void handlePause() {
 
     unsigned char colors[5];
 
-    /*Disable keypad*/
-    keypadDisable = 1;
-    while (keypadKey == KPAD_PAUSE);
-
     /*Dummy music*/
     rmtSuspend();
     rmtInitDummyMusic();
@@ -1531,23 +1158,25 @@ void handlePause() {
     memcpy(colors, (unsigned char*) 0x0C, 5);
     memset((unsigned char*) 0x0C, 0, 5);
     POKE(0x08, 0x00);
+    for (x1 = caveBuffer * DLI_ENTRIES; x1 < caveBuffer * DLI_ENTRIES + dliBands; ++x1) {
+        dliPf0[x1] = 0;
+        dliPf1[x1] = 0;
+        dliPf2[x1] = 0;
+        dliPf3[x1] = 0;
+        dliBk[x1] = 0;
+    }
 
     /*Show "PAUSED text*/
-    memset((unsigned char*) MA_SBMEM, 0, 40);
-    memcpy((unsigned char*) MA_SBMEM, pausedLiteral, 6);
-
-    /*Reenable keypad*/
-    delay(30);
-    keypadKey = KPAD_NONE;
-    keypadDisable = 0;
-
-    /*Wait for pause*/
-    while (keypadKey != KPAD_PAUSE);
-
-    /*Disable keypad*/
-    keypadDisable = 1;
-    delay(30);
-    keypadKey = KPAD_NONE;
+    memset(STATUS_BAR, 0, 40);
+    memcpy(STATUS_BAR, pausedLiteral, 6);
+
+    /*Wait for pause pressed again, a frame each look at the queue. Each
+     *press is one event, so the key still held from pausing does not
+     *count
+     */
+    while (keyTake() != KPAD_PAUSE) {
+        waitFrame();
+    }
 
     /*Game music*/
     rmtSuspend();
@@ -1559,32 +1188,10 @@ void handlePause() {
     /*Restore colors and normal status bar*/
     memcpy((unsigned char*) 0x0C, colors, 5);
     POKE(0x08, 0xC8);
+    setDliEntries();
     updateStatusBar();
 
-    /*Enable keypad*/
-    keypadDisable = 0;
-
-}
-
-/*Relocate RMT routines and music file*/
-void relocateRmt() {
-
-    /*RMT Player*/
-    memcpy((unsigned char*) MA_RMT_AUX1,
-            &(CLM_RMT_AUX1),
-            (unsigned char*) &CLM_RMT_AUX2 - (unsigned char*) &CLM_RMT_AUX1);
-
-    memcpy((unsigned char*) MA_RMT_AUX2,
-            &(CLM_RMT_AUX2),
-            (unsigned char*) &CLM_RMT_MAIN - (unsigned char*) &CLM_RMT_AUX2);
-
-    memcpy((unsigned char*) MA_RMT_MAIN,
-            &(CLM_RMT_MAIN),
-            (unsigned char*) &CLM_RMT_MUSIC - (unsigned char*) &CLM_RMT_MAIN);
-
-    /*RMT music file*/
-    memcpy((unsigned char*) MA_RMT_MUSIC,
-            &(CLM_RMT_MUSIC),
-            (unsigned char*) &CLM_RMT_MUSIC_END - (unsigned char*) &CLM_RMT_MUSIC);
+    /*The paused frames are not caught up*/
+    lastTick = frameTick;
 
 }
\ No newline at end of file
@@ -0,0 +1,77 @@
+;Curse of the lost miner - RMT module saved for $2400, made by clmrmt
+;from rmt_music.bin. Addresses are relative to _CLM_RMT_MUSIC
+
+_CLM_RMT_MUSIC:
+.byte $52,$4D,$54,$34,$20,$10,$01,$01
+.word _CLM_RMT_MUSIC+$0010
+.word _CLM_RMT_MUSIC+$0024
+.word _CLM_RMT_MUSIC+$0029
+.word _CLM_RMT_MUSIC+$028D
+.word _CLM_RMT_MUSIC+$002E
+.word _CLM_RMT_MUSIC+$004C
+.word _CLM_RMT_MUSIC+$00AA
+.word _CLM_RMT_MUSIC+$00CC
+.word _CLM_RMT_MUSIC+$00EB
+.word _CLM_RMT_MUSIC+$0110
+.word _CLM_RMT_MUSIC+$012D
+.word _CLM_RMT_MUSIC+$0175
+.word _CLM_RMT_MUSIC+$01A0
+.word _CLM_RMT_MUSIC+$01C9
+.byte <(_CLM_RMT_MUSIC+$01E5)
+.byte <(_CLM_RMT_MUSIC+$01FF)
+.byte <(_CLM_RMT_MUSIC+$0218)
+.byte <(_CLM_RMT_MUSIC+$0246)
+.byte <(_CLM_RMT_MUSIC+$0274)
+.byte >(_CLM_RMT_MUSIC+$01E5)
+.byte >(_CLM_RMT_MUSIC+$01FF)
+.byte >(_CLM_RMT_MUSIC+$0218)
+.byte >(_CLM_RMT_MUSIC+$0246)
+.byte >(_CLM_RMT_MUSIC+$0274)
+.byte $0E,$0C,$1B,$0F,$00,$00,$40,$00,$00,$00,$00,$00,$03,$07,$0C,$66
+.byte $0A,$00,$55,$0A,$00,$55,$0A,$00,$44,$0A,$00,$44,$0A,$00,$0C,$0C
+.byte $5B,$0D,$00,$00,$80,$50,$00,$00,$00,$00,$00,$DD,$0C,$00,$DD,$0C
+.byte $00,$DD,$0C,$00,$DD,$0C,$00,$CC,$0C,$00,$BB,$0C,$00,$AA,$0C,$00
+.byte $99,$0C,$00,$88,$0C,$00,$77,$0C,$00,$66,$0C,$00,$55,$0C,$00,$44
+.byte $0C,$00,$22,$0C,$00,$22,$0C,$00,$11,$0C,$00,$11,$0C,$00,$11,$0C
+.byte $00,$11,$0C,$00,$11,$0C,$00,$11,$0C,$00,$11,$0C,$00,$11,$0C,$00
+.byte $11,$0C,$00,$11,$0C,$00,$11,$0C,$00,$11,$0C,$00,$0C,$0C,$1F,$1F
+.byte $00,$00,$FF,$00,$00,$00,$00,$00,$00,$DD,$1A,$60,$BB,$1A,$68,$AA
+.byte $1A,$70,$88,$1A,$78,$55,$1A,$80,$33,$1A,$88,$11,$1A,$90,$0C,$0C
+.byte $1C,$0D,$00,$40,$80,$00,$00,$00,$00,$00,$00,$CC,$00,$00,$BB,$00
+.byte $00,$AA,$00,$00,$99,$00,$00,$88,$00,$00,$77,$00,$00,$0C,$0C,$22
+.byte $0D,$00,$00,$00,$00,$00,$00,$00,$00,$00,$DD,$0C,$00,$CC,$0C,$00
+.byte $BB,$0C,$00,$AA,$0C,$00,$99,$0C,$00,$88,$0C,$00,$77,$0C,$00,$66
+.byte $0C,$00,$0D,$0C,$1A,$1A,$80,$00,$F0,$00,$00,$00,$00,$00,$00,$FF
+.byte $FF,$0A,$00,$EE,$0A,$00,$DD,$0A,$00,$CC,$0A,$00,$BB,$0A,$00,$11
+.byte $0F,$45,$12,$80,$00,$27,$00,$00,$00,$01,$00,$50,$40,$30,$15,$09
+.byte $00,$FF,$0A,$00,$FF,$0A,$00,$FF,$0A,$00,$FF,$0A,$00,$FF,$0A,$00
+.byte $FF,$0A,$00,$FF,$0A,$00,$FF,$0A,$00,$FF,$0A,$00,$FF,$0A,$00,$FF
+.byte $0A,$00,$FF,$0A,$00,$FF,$0A,$00,$FF,$0A,$00,$FF,$0A,$00,$FF,$0A
+.byte $00,$FF,$0A,$00,$FF,$0A,$00,$0C,$0C,$28,$22,$00,$00,$50,$00,$00
+.byte $00,$00,$00,$00,$FF,$1A,$8F,$CC,$1A,$9F,$EE,$18,$07,$55,$1C,$10
+.byte $BB,$18,$07,$44,$1C,$10,$99,$18,$07,$33,$1C,$10,$66,$18,$07,$22
+.byte $1C,$10,$10,$0E,$26,$1A,$04,$00,$40,$00,$00,$00,$00,$00,$00,$03
+.byte $07,$0E,$0C,$88,$0A,$00,$CC,$0A,$00,$EE,$0A,$00,$FF,$0A,$00,$CC
+.byte $0A,$00,$99,$0A,$00,$77,$0A,$00,$66,$0A,$00,$0C,$0C,$19,$19,$00
+.byte $00,$00,$00,$00,$00,$00,$00,$00,$AA,$1A,$70,$88,$1A,$60,$88,$1A
+.byte $50,$88,$1A,$40,$00,$1A,$30,$FE,$90,$0C,$3E,$05,$90,$0C,$FE,$90
+.byte $0C,$7E,$90,$0C,$90,$0C,$90,$0C,$3E,$05,$90,$0C,$3E,$05,$90,$0C
+.byte $BE,$09,$11,$7E,$3D,$00,$FE,$06,$11,$7E,$3D,$00,$3E,$0B,$06,$11
+.byte $7E,$3D,$00,$FE,$0D,$11,$7E,$3D,$00,$FE,$3F,$09,$98,$01,$98,$01
+.byte $7E,$98,$01,$7E,$98,$01,$BE,$9C,$01,$9C,$01,$7E,$9C,$01,$7E,$9C
+.byte $01,$BE,$98,$01,$98,$01,$7E,$98,$01,$7E,$98,$01,$BE,$90,$01,$90
+.byte $01,$7E,$90,$01,$7E,$90,$01,$BE,$3F,$09,$9A,$01,$9A,$01,$7E,$9A
+.byte $01,$7E,$9A,$01,$BE,$9F,$01,$9F,$01,$7E,$9F,$01,$7E,$9F,$01,$BE
+.byte $9A,$01,$9A,$01,$7E,$9A,$01,$7E,$9A,$01,$BE,$95,$01,$95,$01,$7E
+.byte $95,$01,$7E,$95,$01,$BE,$0E,$06,$3E,$04,$09,$06,$3E,$04,$8B,$05
+.byte $3E,$04,$8C,$05,$3E,$04,$09,$05,$FE,$BD,$00,$3D,$00,$3E,$06,$FF
+.byte $FF,$02,$FF,$FF,$FF,$03,$FF,$FF,$FF,$02,$FF,$FF,$FF,$03,$FF,$FF
+.byte $FF,$03,$FF,$FF,$02,$03,$FF,$FF,$FF,$02,$FF,$FF,$FF,$03,$FF,$FF
+.byte $02,$03,$FF,$03,$02,$02,$03,$FE,$01
+.word _CLM_RMT_MUSIC+$0291
+.byte $00,$FF,$01,$FF,$00,$FF,$01,$FF,$FE,$0B
+.word _CLM_RMT_MUSIC+$02B9
+.byte $FF,$FF,$04,$FF,$FE,$0E
+.word _CLM_RMT_MUSIC+$02C5
+.byte $FF,$FF,$FF,$FF,$FE,$10
+.word _CLM_RMT_MUSIC+$02CD
@@ -0,0 +1,483 @@
+;===============================================================================
+;Curse of the lost miner
+;===============================================================================
+
+;Raster Music Tracker player, 5200 version. Disassembled from the binary
+;that used to be copied to 7936 at power-on and reassembled to run from
+;the cartridge. The player changed five of its own operands, these are
+;variables now. The volume and frequency tables are in data.s, the
+;frequency table page aligned
+;
+;Entry points
+;rmtInit      X/Y music address, A song line
+;rmtPlay      once per frame
+;rmtP3        instrument update without the song
+;rmtSilence   all channels quiet
+;rmtSetPokey  write the channels to POKEY
+;rmtSfx       X channel, A note, Y instrument * 2
+
+.import _CLM_RMT_VOLUME
+.import _CLM_RMT_FREQ
+
+;Zero page used by the player: $EB-$FC
+
+;Channel variables, 109 bytes. Four bytes per field, one for each channel:
+;+0/+4 track address, +8 track index, +12 frames to next note, +16 note,
+;+20 volume, +32 instrument * 2 ($80 none), +36/+40 instrument address,
+;+44 instrument index, +96/+100 AUDF/AUDC out, +104 AUDCTL bits.
+;+108 frames to the next song line
+RMT_VARS = $1CE0
+.assert RMT_VARS >= 6144 + 23 * 40 && RMT_VARS + 109 <= 8192, error, "RMT variables overlap a cave display memory"
+
+;Operands the original player modified
+.segment "DATA"
+rmtTrackLine:
+.byte $FF
+rmtTrackLength:
+.byte $FF
+rmtSpeed:
+.byte $FF
+rmtLineSpeed:
+.byte $FF
+rmtAudctl:
+.byte $FF
+
+;Distortions - low byte of the frequency table and AUDC bits
+.segment "RODATA"
+rmtDistortion:
+.byte $80,$00,$80,$20,$80,$40,$00,$C0,$80,$80,$80,$A0,$00,$C0,$40,$C0
+
+.segment "CODE"
+rmtInit:
+	jmp _rp1
+rmtPlay:
+	jmp _rp26
+rmtP3:
+	jmp _rp29
+rmtSilence:
+	jmp _rp4
+rmtSetPokey:
+	jmp _rp44
+rmtSfx:
+	jmp _rp24
+_rp1:
+	stx $F3
+	sty $F4
+	pha
+	ldy #$6D
+	lda #$00
+_rp2:
+	sta RMT_VARS-1,y
+	dey
+	bne _rp2
+	ldy #$04
+	lda ($F3),y
+	sta rmtTrackLength
+	iny
+	lda ($F3),y
+	sta rmtSpeed
+	ldy #$08
+_rp3:
+	lda ($F3),y
+	sta $00E3,y
+	iny
+	cpy #$10
+	bne _rp3
+	pla
+	pha
+	asl
+	asl
+	clc
+	adc $F1
+	sta $F1
+	pla
+	php
+	and #$C0
+	asl
+	rol
+	rol
+	plp
+	adc $F2
+	sta $F2
+	jsr _rp6
+_rp4:
+	lda #$00
+	sta $EB08
+	ldy #$03
+	sty $EB0F
+	ldy #$08
+_rp5:
+	sta $EB00,y
+	dey
+	bpl _rp5
+	lda #$01
+	rts
+_rp6:
+	ldx #$00
+	stx rmtTrackLine
+_rp7:
+	txa
+	tay
+	lda ($F1),y
+	cmp #$FE
+	bcs _rp9
+	tay
+	lda ($ED),y
+	sta RMT_VARS,x
+	lda ($EF),y
+	sta RMT_VARS+4,x
+	lda #$00
+	sta RMT_VARS+8,x
+	lda #$01
+_rp8:
+	sta RMT_VARS+12,x
+	lda #$80
+	sta RMT_VARS+32,x
+	inx
+	cpx #$04
+	bne _rp7
+	lda $F1
+	clc
+	adc #$04
+	sta $F1
+	bcc _rp11
+	inc $F2
+	jmp _rp11
+_rp9:
+	beq _rp10
+	lda #$00
+	beq _rp8
+_rp10:
+	ldy #$02
+	lda ($F1),y
+	tax
+	iny
+	lda ($F1),y
+	sta $F2
+	stx $F1
+	ldx #$00
+	beq _rp7
+_rp11:
+	lda rmtSpeed
+	sta rmtLineSpeed
+	ldx #$FF
+_rp12:
+	inx
+	dec RMT_VARS+12,x
+	bne _rp15
+	lda RMT_VARS,x
+	sta $F3
+	lda RMT_VARS+4,x
+	sta $F4
+_rp13:
+	ldy RMT_VARS+8,x
+	inc RMT_VARS+8,x
+	lda ($F3),y
+	sta $F9
+	and #$3F
+	cmp #$3D
+	beq _rp14
+	bcs _rp16
+	sta RMT_VARS+16,x
+	iny
+	lda ($F3),y
+	lsr
+	and #$7E
+	sta RMT_VARS+32,x
+_rp14:
+	lda #$01
+	sta RMT_VARS+12,x
+	ldy RMT_VARS+8,x
+	inc RMT_VARS+8,x
+	lda ($F3),y
+	lsr
+	ror $F9
+	lsr
+	ror $F9
+	lda $F9
+	and #$F0
+	sta RMT_VARS+20,x
+_rp15:
+	cpx #$03
+	bne _rp12
+	lda rmtLineSpeed
+	sta rmtSpeed
+	sta RMT_VARS+108
+	jmp _rp23
+_rp16:
+	cmp #$3F
+	beq _rp18
+	lda $F9
+	and #$C0
+	beq _rp17
+	asl
+	rol
+	rol
+	sta RMT_VARS+12,x
+	jmp _rp15
+_rp17:
+	iny
+	lda ($F3),y
+	sta RMT_VARS+12,x
+	inc RMT_VARS+8,x
+	jmp _rp15
+_rp18:
+	lda $F9
+	bmi _rp19
+	iny
+	lda ($F3),y
+	sta rmtLineSpeed
+	inc RMT_VARS+8,x
+	jmp _rp13
+_rp19:
+	cmp #$FF
+	beq _rp20
+	iny
+	lda ($F3),y
+	sta RMT_VARS+8,x
+	jmp _rp13
+_rp20:
+	jmp _rp6
+_rp21:
+	jmp _rp29
+_rp22:
+	dex
+	bmi _rp21
+_rp23:
+	ldy RMT_VARS+32,x
+	bmi _rp22
+	jsr _rp25
+	jmp _rp22
+_rp24:
+	sta RMT_VARS+16,x
+	lda #$F0
+	sta RMT_VARS+20,x
+_rp25:
+	lda ($EB),y
+	sta RMT_VARS+36,x
+	sta $F7
+	iny
+	lda ($EB),y
+	sta RMT_VARS+40,x
+	sta $F8
+	ldy #$01
+	lda ($F7),y
+	sta RMT_VARS+88,x
+	iny
+	lda ($F7),y
+	sta RMT_VARS+48,x
+	iny
+	lda ($F7),y
+	sta RMT_VARS+52,x
+	iny
+	lda ($F7),y
+	sta RMT_VARS+72,x
+	and #$3F
+	sta RMT_VARS+92,x
+	iny
+	lda ($F7),y
+	sta RMT_VARS+104,x
+	iny
+	lda ($F7),y
+	sta RMT_VARS+60,x
+	iny
+	lda ($F7),y
+	sta RMT_VARS+68,x
+	lda #$80
+	sta RMT_VARS+64,x
+	sta RMT_VARS+32,x
+	asl
+	sta RMT_VARS+56,x
+	sta RMT_VARS+28,x
+	tay
+	lda ($F7),y
+	sta RMT_VARS+84,x
+	adc #$00
+	sta RMT_VARS+44,x
+	lda #$0C
+	sta RMT_VARS+80,x
+	tay
+	lda ($F7),y
+	sta RMT_VARS+76,x
+	rts
+_rp26:
+	jsr _rp44
+	dec RMT_VARS+108
+	bne _rp29
+	inc rmtTrackLine
+	lda rmtTrackLine
+	cmp rmtTrackLength
+	beq _rp27
+	jmp _rp11
+_rp27:
+	jmp _rp6
+_rp28:
+	jmp _rp42
+_rp29:
+	lda #>_CLM_RMT_FREQ
+	sta $F6
+	ldx #$03
+_rp30:
+	lda RMT_VARS+40,x
+	beq _rp28
+	sta $F4
+	lda RMT_VARS+36,x
+	sta $F3
+	ldy RMT_VARS+44,x
+	lda ($F3),y
+	sta $F9
+	iny
+	lda ($F3),y
+	sta $FA
+	iny
+	lda ($F3),y
+	sta $FB
+	iny
+	tya
+	cmp RMT_VARS+48,x
+	bcc _rp31
+	beq _rp31
+	lda #$80
+	sta RMT_VARS+56,x
+	lda RMT_VARS+52,x
+_rp31:
+	sta RMT_VARS+44,x
+	lda $F9
+	and #$0F
+	ora RMT_VARS+20,x
+	tay
+	lda _CLM_RMT_VOLUME,y
+	sta $FC
+	lda $FA
+	and #$0E
+	tay
+	lda rmtDistortion,y
+	sta $F5
+	lda $FC
+	ora rmtDistortion+1,y
+	sta RMT_VARS+100,x
+	ldy RMT_VARS+84,x
+	cpy #$0D
+	bcc _rp35
+	lda RMT_VARS+92,x
+	bpl _rp34
+	tya
+	cmp RMT_VARS+80,x
+	bne _rp32
+	lda RMT_VARS+88,x
+	sta RMT_VARS+80,x
+	bne _rp33
+_rp32:
+	inc RMT_VARS+80,x
+_rp33:
+	lda RMT_VARS+36,x
+	sta $F7
+	lda RMT_VARS+40,x
+	sta $F8
+	ldy RMT_VARS+80,x
+	lda ($F7),y
+	sta RMT_VARS+76,x
+	lda RMT_VARS+72,x
+	and #$3F
+_rp34:
+	sec
+	sbc #$01
+	sta RMT_VARS+92,x
+_rp35:
+	lda RMT_VARS+56,x
+	bpl _rp36
+	lda RMT_VARS+20,x
+	beq _rp36
+	cmp RMT_VARS+68,x
+	beq _rp36
+	bcc _rp36
+	tay
+	lda RMT_VARS+64,x
+	clc
+	adc RMT_VARS+60,x
+	sta RMT_VARS+64,x
+	bcc _rp36
+	tya
+	sbc #$10
+	sta RMT_VARS+20,x
+_rp36:
+	lda $FA
+	and #$70
+	beq _rp37
+	lda $FB
+	jmp _rp41
+_rp37:
+	lda RMT_VARS+16,x
+	clc
+	adc $FB
+	ldy RMT_VARS+72,x
+	bmi _rp39
+	clc
+	adc RMT_VARS+76,x
+	cmp #$3D
+	bcc _rp38
+	lda #$00
+	sta RMT_VARS+100,x
+	lda #$3F
+_rp38:
+	tay
+	lda ($F5),y
+	clc
+	adc RMT_VARS+28,x
+	jmp _rp41
+_rp39:
+	cmp #$3D
+	bcc _rp40
+	lda #$00
+	sta RMT_VARS+100,x
+	lda #$3F
+_rp40:
+	tay
+	lda RMT_VARS+28,x
+	clc
+	adc RMT_VARS+76,x
+	clc
+	adc ($F5),y
+_rp41:
+	sta RMT_VARS+96,x
+_rp42:
+	dex
+	bmi _rp43
+	jmp _rp30
+_rp43:
+	lda RMT_VARS+104
+	ora RMT_VARS+105
+	ora RMT_VARS+106
+	ora RMT_VARS+107
+	tax
+	stx rmtAudctl
+	stx rmtAudctl
+	lda #$01
+	rts
+_rp44:
+	ldy rmtAudctl
+	lda RMT_VARS+96
+	ldx RMT_VARS+100
+	sta $EB00
+	stx $EB01
+	lda RMT_VARS+97
+	ldx RMT_VARS+101
+	sta $EB02
+	stx $EB03
+	lda RMT_VARS+98
+	ldx RMT_VARS+102
+	sta $EB04
+	stx $EB05
+	lda RMT_VARS+99
+	ldx RMT_VARS+103
+	sta $EB06
+	stx $EB07
+	sty $EB08
+	rts
+
+.export rmtInit
+.export rmtPlay
+.export rmtP3
+.export rmtSilence
+.export rmtSetPokey
+.export rmtSfx
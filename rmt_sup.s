@@ -2,62 +2,235 @@
 ;Curse of the lost miner
 ;===============================================================================
 
+;Frame time meter - times the VBI and the DLIs. Set it together with
+;CLM_METER in main.c
+;CLM_METER = 1
+
+;RMT player and music
+.import rmtInit
+.import rmtPlay
+.import rmtP3
+.import rmtSfx
+.import _CLM_RMT_MUSIC
+
+;Miner images, main.c
+.import _minerImages
+
+;Paint queue of the game core, clmcore.c
+.import _clmPaintHead
+.import _clmPaintTail
+.import _clmPaintLo
+.import _clmPaintHi
+.import _clmPaintChar
+CLM_PAINT_QUEUE_SIZE = 16	;clmcore.h
+PAINT_PTR = $FD			;Zero page, used by the VBI only
+
 ;Supplementary variables
 .segment "DATA"
 _vbistorel:
 .byte 0
 _vbistoreh:
 .byte 0
-_sfx:
-.byte 0
 _suspend:
 .byte 0
-_mvDelay:
+_secondFire:
+.byte $00
+_frameTick:
 .byte 0
-_colorStore1:
+
+;Miner sprite. The game sets the target, the VBI moves the player there
+_minerTargetX:
+.byte 0		;HPOSP0 to go to
+_minerTargetY:
+.byte 0		;Top row of player 0 to go to
+_minerFrame:
+.byte 0		;Image, 8 bytes each in _minerImages
+_minerSnap:
+.byte 0		;Not 0 - go to the target at once
+;Where the VBI has put the player
+_minerHpos:
 .byte 0
-_colorStore2:
+_minerRow:
 .byte 0
-_keypadKey:
+_minerRowFrame:
 .byte $FF
-_keypadDisable:
-.byte $00
-_secondFire:
-.byte $00
+_minerNewRow:
+.byte 0
+_minerGoal:
+.byte 0
+_minerCount:
+.byte 0
+
+;Animated tiles. Font page of each frame, 0 in _animOn keeps ANTIC.chbase
+ANIM_FRAMES = 4
+ANIM_DELAY = 8		;VBIs a frame is shown
+_animOn:
+.byte 0
+_caveFont:
+.byte 0		;Page of the frame shown, DLIs go back to it
+_animPages:
+.byte 0,0,0,0
+_animFrame:
+.byte 0
+_animDelay:
+.byte ANIM_DELAY
+
+;Keypad events. The keypad interrupt adds a key when it goes down, the
+;VBI adds it again with KEY_RELEASED when it is let go, the game takes
+;them from the tail. The VBI can come in over the interrupt, so it leaves
+;a release for the next frame while _keyBusy is set
+KEY_QUEUE_SIZE = 8
+KEY_RELEASED = $80
+_keyQueue:
+.byte 0,0,0,0,0,0,0,0
+_keyHead:
+.byte 0
+_keyTail:
+.byte 0
+_keyDown:
+.byte $FF		;Key held, $FF none
+_keyBusy:
+.byte 0
+
+;Joystick, sampled by the VBI. _joyState holds the directions and fire
+;held now as JS_LOG_ bits of clmcore.h. A bit of _joyPressedFlip flips
+;each time it is pressed, of _joyReleasedFlip each time it is let go; the
+;game keeps what it has seen itself, so neither side waits for the other
+JS_LOW = 76		;POT below - left or up
+JS_HIGH = 152		;POT above - right or down
+JOY_HYSTERESIS = 8	;POT steps back needed to let a direction go
+_joyState:
+.byte 0
+_joyPressedFlip:
+.byte 0
+_joyReleasedFlip:
+.byte 0
+_joyHysteresis:
+.byte JOY_HYSTERESIS
+_joyNew:
+.byte 0
+_joyFireRaw:
+.byte 0
+_joyPot:
+.byte 0
+_joyLow:
+.byte 0
+_joyHigh:
+.byte 0
+_joyTmp:
+.byte 0
+
+;DLI table, DLI_ENTRIES for each cave display list, filled by main.c.
+;An entry is the look of the rows below a DLI: the font page (0 the cave
+;font) and the colors. The VBI starts each frame at _dliStart, each DLI
+;takes the next entry
+DLI_ENTRIES = 8
+_dliFont:
+.res DLI_ENTRIES*2
+_dliPf0:
+.res DLI_ENTRIES*2
+_dliPf1:
+.res DLI_ENTRIES*2
+_dliPf2:
+.res DLI_ENTRIES*2
+_dliPf3:
+.res DLI_ENTRIES*2
+_dliBk:
+.res DLI_ENTRIES*2
+_dliStart:
+.byte 0
+_dliNext:
+.byte 0
+
+.ifdef CLM_METER
+;VCOUNT when the VBI and the DLI began, the most taken since main.c
+;last cleared them, in VCOUNT steps of 2 scanlines. The DLIs of a frame
+;are added up
+_meterVbiStart:
+.byte 0
+_meterVbiWorst:
+.byte 0
+_meterDliStart:
+.byte 0
+_meterDli:
+.byte 0
+_meterDliWorst:
+.byte 0
+.endif
+
+;Sound effect requests. The main program adds them at the head, the VBI
+;takes them from the tail. Each side writes only its own index, so no
+;locking is needed. One slot stays free to tell a full queue from an
+;empty one
+SFX_QUEUE_SIZE = 4
+_sfxQueue:
+.byte 0,0,0,0
+_sfxHead:
+.byte 0
+_sfxTail:
+.byte 0
+;Effect and its priority picked for each channel in this VBI, 0 none
+_sfxPick:
+.byte 0,0,0,0
+_sfxPickPri:
+.byte 0,0,0,0
+_sfxNow:
+.byte 0
+_sfxNowPri:
+.byte 0
+_sfxChan:
+.byte 0
 
 ;==============================================================================
-; DLI Different colors and character set for status bar
+; DLI - font and colors of the rows below, from the DLI table
 ;==============================================================================
 
+;The DLI comes on the last scanline of a row, which leaves the CPU about
+;47 cycles before WSYNC at cycle 105 while ANTIC fetches the characters.
+;NMI and BIOS dispatch take 18 of them, the handler 20 up to WSYNC, with
+;COLPF0 loaded. It is stored at once, the font and COLPF3 within about
+;25 cycles, before the next row starts. COLPF1, COLPF2 and COLBK follow,
+;a band changing them may show them a few characters late on its first
+;scanline. The status bar DLIs come on blank lines
 .segment "CODE"
 _dliHandler:
 	pha
-	sta 54282	;Horiz retrace 
-	lda #48		;DARK BG
-	sta 53272-4096
-	lda #12
-	sta 53271-4096	;BRIGHT FONT
-	lda #<_dliHandler2
-	sta $0206
-	lda #>_dliHandler2
-	sta $0207
-	pla
-	rti
-_dliHandler2:
+	txa
 	pha
-	sta 54282	;Horiz retrace
-	;Restore colors, swap after DLI
-	lda _colorStore2	;BLACK BG
-	sta 53272-4096
-	lda _colorStore1
-	sta 53271-4096
-	lda #<_dliHandler
-	sta $0206
-	lda #>_dliHandler
-	sta $0207
+.ifdef CLM_METER
+	lda 54283	;VCOUNT, 8 cycles of the budget
+	sta _meterDliStart
+.endif
+	ldx _dliNext
+	lda _dliPf0,x
+	sta 54282	;WSYNC
+	sta 53270-4096	;COLPF0
+	lda _dliFont,x
+	bne _d1
+	lda _caveFont
+_d1:	sta 54281	;CHBASE
+	lda _dliPf3,x
+	sta 53273-4096	;COLPF3
+	lda _dliPf1,x
+	sta 53271-4096	;COLPF1
+	lda _dliPf2,x
+	sta 53272-4096	;COLPF2
+	lda _dliBk,x
+	sta 53274-4096	;COLBK
+	inc _dliNext
+.ifdef CLM_METER
+	lda 54283
+	sec
+	sbc _meterDliStart
+	clc
+	adc _meterDli
+	sta _meterDli
+.endif
+	pla
+	tax
 	pla
 	rti
-	
+
 ;===============================================================================
 ; Break key handler
 ;===============================================================================
@@ -76,56 +249,375 @@ _breakHandler:
 _keypadCont:
 
 _kc1:  pha                 ;Save A
-       lda _keypadDisable  ;Check if keypad disabled?
-       beq _kc2            ;If enabled, register the key
-       lda #$FF            ;If not, place no key
-       sta _keypadKey
+       inc _keyBusy        ;The VBI leaves the queue alone
+       cmp _keyDown        ;Repeat of the key held?
+       beq _kc2            ;No new event
+       sta _keyDown
+       txa                 ;Save X
+       pha
+       lda _keyDown
+       jsr _keyPush        ;Key pressed
+       pla                 ;Restore X
+       tax
+_kc2:  dec _keyBusy
        pla                 ;Restore A
        jmp $FCB2           ;Continue with original handler
 
-_kc2:  pla                 ;Restore A
-       sta _keypadKey      ;Store last key pressed
-_kc3:  jmp $FCB2           ;Continue with original handler
+;-Add the event in A to the keypad queue. Dropped when the queue is full
+_keyPush:
+       ldx _keyHead
+       sta _keyQueue,x     ;Not seen by the game before the head moves
+       inx
+       txa
+       and #KEY_QUEUE_SIZE-1
+       cmp _keyTail
+       beq _kp1
+       sta _keyHead
+_kp1:  rts
 
 ;===============================================================================
-;VBI. Movement delay, Calling RMT
+;VBI. Calling RMT
 ;===============================================================================
 .segment "CODE"
 _vbiRoutine:
 	php
 	pla
+.ifdef CLM_METER
+	lda 54283	;VCOUNT
+	sta _meterVbiStart
+.endif
 	;No attract
 	lda #0
 	sta 4
-	;Movement delay
-	lda _mvDelay
-	cmp #0
-	beq _n
-	dec _mvDelay
+
+	;Tell the game loop a new frame has started
+	inc _frameTick
+
+	;DLIs of the display list ANTIC starts now
+	lda _dliStart
+	sta _dliNext
+
+	;Cave cells painted since the last VBI, two characters each. At
+	;most CLM_PAINT_QUEUE_SIZE-1 are waiting
+	ldx _clmPaintTail
+_p1:	cpx _clmPaintHead
+	beq _p2
+	lda _clmPaintLo,x
+	sta PAINT_PTR
+	lda _clmPaintHi,x
+	sta PAINT_PTR+1
+	lda _clmPaintChar,x
+	ldy #0
+	sta (PAINT_PTR),y
+	iny
+	clc
+	adc #1
+	sta (PAINT_PTR),y
+	inx
+	txa
+	and #CLM_PAINT_QUEUE_SIZE-1
+	tax
+	jmp _p1
+_p2:	stx _clmPaintTail
+
+	;Keypad - the key held let go?
+	lda _keyBusy
+	bne _k1
+	lda _keyDown
+	bmi _k1
+	lda 59407	;SKSTAT, bit 2 is 0 while a key is down
+	and #4
+	beq _k1
+	lda _keyDown
+	ora #KEY_RELEASED
+	jsr _keyPush
+	lda #$FF
+	sta _keyDown
+_k1:
+
+	;Joystick, the BIOS has read the POTs
+	lda #0
+	sta _joyNew
+	lda $11		;Horizontal POT
+	ldx #1		;JS_LOG_LEFT
+	ldy #2		;JS_LOG_RIGHT
+	jsr _joyAxis
+	lda $12		;Vertical POT
+	ldx #4		;JS_LOG_UP
+	ldy #8		;JS_LOG_DOWN
+	jsr _joyAxis
+
+	;Fire changes when two VBIs in a row agree
+	ldx #0
+	lda 53264-4096	;TRIG0, 0 is pressed
+	bne _j1
+	ldx #16		;JS_LOG_FIRE
+_j1:	txa
+	cmp _joyFireRaw
+	stx _joyFireRaw
+	beq _j2
+	lda _joyState
+	and #16
+_j2:	ora _joyNew
+
+	;Flip the bits pressed and released
+	tax
+	eor _joyState
+	sta _joyTmp
+	and _joyState
+	eor _joyReleasedFlip
+	sta _joyReleasedFlip
+	txa
+	and _joyTmp
+	eor _joyPressedFlip
+	sta _joyPressedFlip
+	stx _joyState
+
+	;Miner sprite, also while audio is suspended
+	jsr _minerMove
+
+	;Animated tiles - show the next frame of the cave font
+	lda _animOn
+	beq _a1
+	dec _animDelay
+	bne _a1
+	lda #ANIM_DELAY
+	sta _animDelay
+	lda _animFrame
+	clc
+	adc #1
+	and #ANIM_FRAMES-1
+	sta _animFrame
+	tax
+	lda _animPages,x
+	sta _caveFont
+	sta 54281	;CHBASE
+_a1:
 	
 	;if audio is suspended, do not call RMT routines
-_n:	lda _suspend
+	lda _suspend
 	cmp #0
 	bne _x1
         ;jmp _x1 ;@@!!@@
-	;if SFX not requested, continue to music update
-	lda _sfx
-	cmp #0
-	beq _x
-	;SFX
+
+	;Drain the SFX queue, keep the best effect for each channel.
+	;At most SFX_QUEUE_SIZE-1 requests are waiting
+	ldx _sfxTail
+_q1:	cpx _sfxHead
+	beq _q3
+	lda _sfxQueue,x
+	sta _sfxNow
+	lsr
+	tay
+	lda _sfxPriority,y
+	sta _sfxNowPri
+	lda _sfxChannel,y
+	tay
+	lda _sfxNowPri
+	cmp _sfxPickPri,y
+	bcc _q2		;Lower than the one picked for the channel
+	sta _sfxPickPri,y	;Of equal ones, the later wins
+	lda _sfxNow
+	sta _sfxPick,y
+_q2:	inx
+	txa
+	and #SFX_QUEUE_SIZE-1
+	tax
+	jmp _q1
+_q3:	stx _sfxTail
+
+	;SFX - start the picked effects, at most one per channel
 	ldx #3
-	lda #30
-	ldy _sfx
-	jsr 8207
+_q4:	ldy _sfxPick,x
+	beq _q5
 	lda #0
-	sta _sfx
+	sta _sfxPick,x
+	sta _sfxPickPri,x
+	stx _sfxChan
+	lda #30
+	jsr rmtSfx
+	ldx _sfxChan
+_q5:	dex
+	bpl _q4
+
 	;Music update - Call RMT	
-_x:	jsr 8195	
+	jsr rmtPlay	
+
+_x1:
+.ifdef CLM_METER
+	;VCOUNT steps taken, it runs 0-130 and starts over at the top
+	lda 54283
+	sec
+	sbc _meterVbiStart
+	bcs _vm1
+	adc #131
+_vm1:	cmp _meterVbiWorst
+	bcc _vm2
+	sta _meterVbiWorst
+_vm2:
+	;DLIs of the frame before, together
+	lda _meterDli
+	cmp _meterDliWorst
+	bcc _vm3
+	sta _meterDliWorst
+_vm3:	lda #0
+	sta _meterDli
+.endif
 
 	;Call original VBI routine
-_x1:	jmp (_vbistorel)
+	jmp (_vbistorel)
 
 
+;===============================================================================
+; Joystick
+;===============================================================================
+
+;-Directions of one axis to _joyNew. A is the POT, X the bit for its low
+; end, Y for its high end. A direction held lets go only when the POT is
+; _joyHysteresis steps back from where it was taken----------------------
+.segment "CODE"
+
+_joyAxis:
+	sta _joyPot
+	stx _joyLow
+	sty _joyHigh
+
+	;Low end - below JS_LOW, or JS_LOW + hysteresis when held
+	lda _joyState
+	and _joyLow
+	beq _ja1
+	lda _joyHysteresis
+_ja1:	clc
+	adc #JS_LOW
+	cmp _joyPot
+	beq _ja2
+	bcc _ja2
+	lda _joyLow
+	bne _ja4
+
+	;High end - above JS_HIGH, or JS_HIGH - hysteresis when held
+_ja2:	lda _joyState
+	and _joyHigh
+	beq _ja3
+	lda _joyHysteresis
+_ja3:	sta _joyTmp
+	lda #JS_HIGH
+	sec
+	sbc _joyTmp
+	cmp _joyPot
+	bcs _ja5
+	lda _joyHigh
+_ja4:	ora _joyNew
+	sta _joyNew
+_ja5:	rts
+
+;===============================================================================
+; Miner sprite
+;===============================================================================
+MINER_P0 = $1400	;Player 0 - MA_PMGSTART + 1024 in main.c
+MINER_HPOSP0 = 53248-4096
+MINER_SNAP = 32		;Distance not worth gliding, 4 cells
+
+;-Move the player a step toward the target, redraw only what changed.
+; At most 8 rows cleared and 8 drawn, about 550 cycles-----------------
+.segment "CODE"
+
+_minerMove:
+	;Horizontal
+	lda _minerTargetX
+	sta _minerGoal
+	lda _minerHpos
+	jsr _minerStep
+	cmp _minerHpos
+	beq _mm1
+	sta _minerHpos
+	sta MINER_HPOSP0
+
+	;Vertical
+_mm1:	lda _minerTargetY
+	sta _minerGoal
+	lda _minerRow
+	jsr _minerStep
+	sta _minerNewRow
+	lda #0
+	sta _minerSnap
+	lda _minerNewRow
+	cmp _minerRow
+	bne _mm2
+	lda _minerFrame
+	cmp _minerRowFrame
+	beq _mm6
+
+	;Clear the old rows the new image does not cover
+_mm2:	ldx _minerRow
+	ldy #8
+_mm3:	txa
+	sec
+	sbc _minerNewRow
+	cmp #8
+	bcc _mm4
+	lda #0
+	sta MINER_P0,x
+_mm4:	inx
+	dey
+	bne _mm3
+
+	;Draw the image at the new row
+	lda _minerFrame
+	sta _minerRowFrame
+	asl
+	asl
+	asl
+	tay
+	ldx _minerNewRow
+	stx _minerRow
+	lda #8
+	sta _minerCount
+_mm5:	lda _minerImages,y
+	sta MINER_P0,x
+	inx
+	iny
+	dec _minerCount
+	bne _mm5
+_mm6:	rts
+
+;-A is where the player is, return it moved toward _minerGoal by 1 plus
+; an eighth of the distance. Walking a cell in 8 frames goes a pixel a
+; frame, falling faster catches up a little behind----------------------
+_minerStep:
+	ldx _minerSnap
+	bne _ms3
+	cmp _minerGoal
+	beq _ms4
+	bcs _ms2
+	;Forward
+	sta _minerCount
+	lda _minerGoal
+	sec
+	sbc _minerCount
+	cmp #MINER_SNAP
+	bcs _ms3
+	lsr
+	lsr
+	lsr
+	sec
+	adc _minerCount
+	rts
+	;Back, carry is set
+_ms2:	sta _minerCount
+	sbc _minerGoal
+	cmp #MINER_SNAP
+	bcs _ms3
+	lsr
+	lsr
+	lsr
+	eor #$FF
+	clc
+	adc _minerCount
+	rts
+_ms3:	lda _minerGoal
+_ms4:	rts
+
 ;===============================================================================
 ; Set-up VBI routine
 ;===============================================================================
@@ -174,13 +666,13 @@ _x1:	jmp (_vbistorel)
 
 .proc _rmtInitMenuMusic: near
 .segment "CODE"
-	;Music file is at page 36
-	ldx #0
-	ldy #36
+	;Music file
+	ldx #<_CLM_RMT_MUSIC
+	ldy #>_CLM_RMT_MUSIC
 	;Zeroth song line
 	lda #0
 	;Initialize the tracker
-	jsr 8192
+	jsr rmtInit
 	;End of procedure
 	rts
 .endproc
@@ -190,13 +682,13 @@ _x1:	jmp (_vbistorel)
 ;===============================================================================
 .proc _rmtInitGameMusic: near
 .segment "CODE"
-	;Music file is at page 36
-	ldx #0
-	ldy #36
+	;Music file
+	ldx #<_CLM_RMT_MUSIC
+	ldy #>_CLM_RMT_MUSIC
 	;Eleventh song line
 	lda #11
 	;Initialize the tracker
-	jsr 8192
+	jsr rmtInit
 	;End of procedure
 	rts
 .endproc
@@ -206,13 +698,13 @@ _x1:	jmp (_vbistorel)
 ;===============================================================================
 .proc _rmtInitGameOverMusic: near
 .segment "CODE"
-	;Music file is at page 36
-	ldx #0
-	ldy #36
+	;Music file
+	ldx #<_CLM_RMT_MUSIC
+	ldy #>_CLM_RMT_MUSIC
 	;Fourteenth song line
 	lda #14
 	;Initialize the tracker
-	jsr 8192
+	jsr rmtInit
 	;End of procedure
 	rts
 .endproc
@@ -222,13 +714,13 @@ _x1:	jmp (_vbistorel)
 ;===============================================================================
 .proc _rmtInitDummyMusic: near
 .segment "CODE"
-	;Music file is at page 36
-	ldx #0
-	ldy #36
+	;Music file
+	ldx #<_CLM_RMT_MUSIC
+	ldy #>_CLM_RMT_MUSIC
 	;Sixteenth song line
 	lda #16
 	;Initialize the tracker
-	jsr 8192
+	jsr rmtInit
 	;End of procedure
 	rts
 .endproc
@@ -243,7 +735,7 @@ _x1:	jmp (_vbistorel)
 ;===============================================================================
 .proc _rmtAllStop: near
 .segment "CODE"
-	jsr 8198
+	jsr rmtP3
 	rts
 .endproc
 
@@ -251,14 +743,46 @@ _x1:	jmp (_vbistorel)
 ;===============================================================================
 ; Sound effects
 ;===============================================================================
+;-Effect attributes, indexed by the effect number / 2---
+.segment "RODATA"
+;The diamond and the jump take channel 3, the rest channel 2
+_sfxChannel:
+.byte 0,0,0,0,0
+.byte 3		;10 Diamond
+.byte 2		;12 All diamonds picked
+.byte 2		;14 Death
+.byte 2		;16 Congratulations
+.byte 3		;18 Jump
+;Higher wins when effects for one channel come in the same frame
+_sfxPriority:
+.byte 0,0,0,0,0
+.byte 2		;10 Diamond
+.byte 3		;12 All diamonds picked
+.byte 4		;14 Death
+.byte 4		;16 Congratulations
+.byte 1		;18 Jump
+
+;-Queue an effect, A is the effect. Dropped when the queue is full-----
+.segment "CODE"
+
+_sfxPush:
+	ldx _sfxHead
+	sta _sfxQueue,x	;Not seen by the VBI before the head moves
+	inx
+	txa
+	and #SFX_QUEUE_SIZE-1
+	cmp _sfxTail
+	beq _sp1
+	sta _sfxHead
+_sp1:	rts
+
 ;-Play diamond picked sound------------
 .segment "CODE"
 
 .proc _rmtPlayDiamond :  near
 .segment "CODE"
 	lda #10
-	sta _sfx
-	rts
+	jmp _sfxPush
 .endproc
 
 ;-Play jump sound------------
@@ -267,8 +791,7 @@ _x1:	jmp (_vbistorel)
 .proc _rmtPlayJump :  near
 .segment "CODE"
 	lda #18
-	sta _sfx
-	rts
+	jmp _sfxPush
 .endproc
 
 ;-Play congratulations sound ---------------
@@ -277,8 +800,7 @@ _x1:	jmp (_vbistorel)
 .proc _rmtPlayGratulation :  near
 .segment "CODE"
 	lda #16
-	sta _sfx
-	rts
+	jmp _sfxPush
 .endproc
 
 ;-Play death sound-----------------------
@@ -287,8 +809,7 @@ _x1:	jmp (_vbistorel)
 .proc _rmtPlayDeath : near
 .segment "CODE"
 	lda #14
-	sta _sfx
-	rts
+	jmp _sfxPush
 .endproc
 
 ;-Play all diamonds collected sound
@@ -297,8 +818,7 @@ _x1:	jmp (_vbistorel)
 .proc _rmtPlayPicked : near
 .segment "CODE"
 	lda #12
-	sta _sfx
-	rts
+	jmp _sfxPush
 .endproc
 
 ;-Suspend RMT routine--------
@@ -329,7 +849,6 @@ _x1:	jmp (_vbistorel)
 	jmp 58487
 .endproc
 
-.export _mvDelay
 .export _rmtSuspend
 .export _rmtResume
 .export _rmtPlayPicked
@@ -346,13 +865,40 @@ _x1:	jmp (_vbistorel)
 .export _rmtRestoreVBI
 .export _asmReboot
 .export _dliHandler
-.export _colorStore1
-.export _colorStore2
+.export _dliFont
+.export _dliPf0
+.export _dliPf1
+.export _dliPf2
+.export _dliPf3
+.export _dliBk
+.export _dliStart
 
-.export _keypadKey
-.export _keypadDisable
 .export _keypadCont
+.export _keyQueue
+.export _keyHead
+.export _keyTail
 
 .export _secondFire
 .export _breakHandler
 
+.export _frameTick
+
+.export _minerTargetX
+.export _minerTargetY
+.export _minerFrame
+.export _minerSnap
+
+.export _animOn
+.export _animFrame
+.export _animDelay
+
+.export _joyState
+.export _joyPressedFlip
+.export _joyReleasedFlip
+.export _joyHysteresis
+.ifdef CLM_METER
+.export _meterVbiWorst
+.export _meterDliWorst
+.endif
+.export _animPages
+
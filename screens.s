@@ -0,0 +1,197 @@
+;===============================================================================
+;Curse of the lost miner - text screens
+;===============================================================================
+
+;Menu and text screens, made at build time. Each has a display list that
+;ANTIC reads together with the text straight from the cartridge, so a
+;screen is shown by pointing SDLSTL at it. Empty rows are blank lines of
+;the display list and take no bytes.
+;
+;Text is ANTIC mode 6, 20 characters a row in screen codes. Capitals and
+;digits are drawn in COLPF0, minuscules in COLPF1. Text drawn in COLPF2
+;and COLPF3 stays hidden until showHiddenText() of main.c colors it
+
+;Screen codes of the BIOS font for " " to "_", minuscules stay as they are
+.repeat $40, i
+.charmap $20 + i, i
+.endrep
+
+;Display list
+DL_BLANK8 = $70
+DL_TEXT = $06		;Mode 6, 8 lines
+DL_LMS = $40
+DL_JVB = $41
+
+;Rows of the menu that change, 20 characters each for the starting cave
+;and the game speed. They use the cave display memory, MA_MENUROWS of
+;main.c
+MENU_ROWS = 6144
+
+;-A row of text, blank after the text
+.macro row text
+	.byte text
+	.if .strlen(text) < 20
+	.res 20 - .strlen(text)
+	.endif
+.endmacro
+
+.segment "RODATA"
+
+;===============================================================================
+;Display lists
+;===============================================================================
+
+;-Nothing shown
+_CLM_TEXT_DL_BLANK:
+.byte DL_JVB, <_CLM_TEXT_DL_BLANK, >_CLM_TEXT_DL_BLANK
+
+;-Main menu
+_CLM_TEXT_DL_MENU:
+.byte DL_BLANK8, DL_BLANK8, DL_BLANK8
+.byte DL_LMS + DL_TEXT, <textMenu, >textMenu
+.byte DL_TEXT
+.byte DL_BLANK8
+.byte DL_TEXT
+.byte DL_BLANK8, DL_BLANK8, DL_BLANK8, DL_BLANK8
+.byte DL_TEXT
+.byte DL_BLANK8
+.byte DL_LMS + DL_TEXT, <MENU_ROWS, >MENU_ROWS
+.byte DL_TEXT
+.byte DL_BLANK8
+.byte DL_LMS + DL_TEXT, <textMenuTraining, >textMenuTraining
+.byte DL_BLANK8, DL_BLANK8, DL_BLANK8, DL_BLANK8, DL_BLANK8, DL_BLANK8
+.byte DL_TEXT, DL_TEXT, DL_TEXT, DL_TEXT
+.byte DL_JVB, <_CLM_TEXT_DL_MENU, >_CLM_TEXT_DL_MENU
+
+;-Instructions of the training cave
+_CLM_TEXT_DL_TRAINING:
+.byte DL_BLANK8, DL_BLANK8, DL_BLANK8
+.byte DL_LMS + DL_TEXT, <textTraining, >textTraining
+.byte DL_TEXT
+.byte DL_BLANK8
+.byte DL_TEXT, DL_TEXT, DL_TEXT, DL_TEXT, DL_TEXT
+.byte DL_BLANK8
+.byte DL_TEXT, DL_TEXT, DL_TEXT, DL_TEXT, DL_TEXT
+.byte DL_BLANK8
+.byte DL_TEXT, DL_TEXT, DL_TEXT
+.byte DL_BLANK8
+.byte DL_TEXT, DL_TEXT, DL_TEXT
+.byte DL_BLANK8
+.byte DL_TEXT
+.byte DL_JVB, <_CLM_TEXT_DL_TRAINING, >_CLM_TEXT_DL_TRAINING
+
+;-Game over, "press FIRE" hidden
+_CLM_TEXT_DL_GAME_OVER:
+.byte DL_BLANK8, DL_BLANK8, DL_BLANK8
+.byte DL_BLANK8, DL_BLANK8, DL_BLANK8, DL_BLANK8, DL_BLANK8, DL_BLANK8
+.byte DL_BLANK8, DL_BLANK8, DL_BLANK8, DL_BLANK8, DL_BLANK8
+.byte DL_LMS + DL_TEXT, <textGameOver, >textGameOver
+.byte DL_BLANK8
+.byte DL_TEXT
+.byte DL_JVB, <_CLM_TEXT_DL_GAME_OVER, >_CLM_TEXT_DL_GAME_OVER
+
+;-Congratulations, "press FIRE" hidden
+_CLM_TEXT_DL_CONGRATULATIONS:
+.byte DL_BLANK8, DL_BLANK8, DL_BLANK8
+.byte DL_BLANK8, DL_BLANK8, DL_BLANK8, DL_BLANK8
+.byte DL_LMS + DL_TEXT, <textCongratulations, >textCongratulations
+.byte DL_BLANK8
+.byte DL_TEXT, DL_TEXT, DL_TEXT
+.byte DL_BLANK8, DL_BLANK8, DL_BLANK8, DL_BLANK8
+.byte DL_TEXT
+.byte DL_JVB, <_CLM_TEXT_DL_CONGRATULATIONS, >_CLM_TEXT_DL_CONGRATULATIONS
+
+;-Returning to the menu
+_CLM_TEXT_DL_RETURN:
+.byte DL_BLANK8, DL_BLANK8, DL_BLANK8
+.byte DL_BLANK8, DL_BLANK8, DL_BLANK8, DL_BLANK8, DL_BLANK8
+.byte DL_BLANK8, DL_BLANK8, DL_BLANK8, DL_BLANK8, DL_BLANK8
+.byte DL_LMS + DL_TEXT, <textReturn, >textReturn
+.byte DL_JVB, <_CLM_TEXT_DL_RETURN, >_CLM_TEXT_DL_RETURN
+textDlEnd:
+
+;ANTIC does not read a display list across a 1K boundary
+.assert (textDlEnd - 1) / 1024 = _CLM_TEXT_DL_BLANK / 1024, lderror, "Text display lists cross a 1K boundary"
+
+;===============================================================================
+;Text, the rows of each screen that are not empty
+;===============================================================================
+
+;-Main menu
+textMenu:
+	row "    CURSE OF THE"
+	row "     LOST MINER"
+	row "BAKTRA SOFTWARE 2015"
+	row " FIRE    start game"
+textMenuTraining:
+	row " JS UP   training"
+	row " guide the miner"
+	row " through dangerous"
+	row " caves and collect"
+	row " all diamonds"
+
+;-Rows of the menu that change, copied to MENU_ROWS
+_CLM_TEXT_MENU_ROWS:
+	row " JS L/R  cave"
+	row " JS DOWN speed"
+_CLM_TEXT_NORM:
+.byte "NORM"
+_CLM_TEXT_SLOW:
+.byte "SLOW"
+
+;-Training
+textTraining:
+	row "use joystick to"
+	row "control the miner"
+	row "MOVEMENT"
+	row "js left  left"
+	row "js right right"
+	row "js up   up(ladder)"
+	row "js down down(ladder)"
+	row "JUMPING"
+	row "fire+up"
+	row "high jump"
+	row "fire+left or right"
+	row "long jumps"
+	row "miner can jump only"
+	row "when there is a rock"
+	row "or a ladder below"
+	row "avoid spikes"
+	row "press 0 for suicide"
+	row "press * for menu"
+	row "press FIRE"
+
+;-Game over
+textGameOver:
+	row "    game is over"
+.byte 0, 0, 0, 0, 0
+.byte $F0, $F2, $E5, $F3, $F3, 0, $A6, $A9, $B2, $A5	;press FIRE, hidden
+.res 5
+
+;-Congratulations
+textCongratulations:
+	row "  CONGRATULATIONS"
+	row "  the curse of the"
+	row "  lost miner"
+	row "  has been broken"
+.byte 0, 0
+.byte $F0, $F2, $E5, $F3, $F3, 0, $A6, $A9, $B2, $A5	;press FIRE, hidden
+.res 8
+
+;-Returning to the menu
+textReturn:
+	row "returning to menu..."
+textEnd:
+
+;ANTIC does not read text across a 4K boundary
+.assert (textEnd - 1) / 4096 = textMenu / 4096, lderror, "Text screens cross a 4K boundary"
+
+.export _CLM_TEXT_DL_BLANK
+.export _CLM_TEXT_DL_MENU
+.export _CLM_TEXT_DL_TRAINING
+.export _CLM_TEXT_DL_GAME_OVER
+.export _CLM_TEXT_DL_CONGRATULATIONS
+.export _CLM_TEXT_DL_RETURN
+.export _CLM_TEXT_MENU_ROWS
+.export _CLM_TEXT_NORM
+.export _CLM_TEXT_SLOW